@@ -0,0 +1,95 @@
+import sys
+import json
+import time
+import timeit
+import argparse
+import platform
+
+import numpy as np
+
+import trakr_sdk as trakr
+from trakr_sdk import AlliedDataTypes, QuadDataTypes
+
+# Microbenchmarks of the Python binding round trip (see ../README.md)
+# Results use the JSON layout of Google Benchmark, to be compared with the
+# output of ./bin/trakr_benchmarks.
+#
+# usage : python3 bench_bindings.py [--out results.json] [--min-time 0.5]
+
+def _plan() -> AlliedDataTypes.Plan:
+    plan = AlliedDataTypes.Plan()
+    plan.joint.pos = np.random.rand(trakr.NDOF)
+    plan.joint.vel = np.random.rand(trakr.NDOF)
+    plan.joint.tor = np.random.rand(trakr.NDOF)
+    plan.joint.kp = np.full(trakr.NDOF, 60.0)
+    plan.joint.kd = np.full(trakr.NDOF, 2.0)
+    plan.torso.pos = np.random.rand(6)
+    plan.torso.vel = np.random.rand(6)
+    return plan
+
+def _measure(name : str, fn, min_time : float) -> dict:
+    # grow the iteration count until a run lasts min_time, as Google Benchmark does
+    iterations = 1
+    while(True):
+        elapsed_cpu = time.process_time()
+        elapsed = timeit.timeit(fn, number=iterations)
+        elapsed_cpu = time.process_time() - elapsed_cpu
+        if((elapsed >= min_time) or (iterations >= 1e9)):
+            break
+        iterations = int(iterations * max(min(1.4 * min_time / max(elapsed, 1e-9), 10.0), 2.0))
+
+    return {
+        "name" : name,
+        "run_name" : name,
+        "run_type" : "iteration",
+        "iterations" : iterations,
+        "real_time" : elapsed * 1e9 / iterations,
+        "cpu_time" : elapsed_cpu * 1e9 / iterations,
+        "time_unit" : "ns",
+    }
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--out", default=None, help="write the JSON results to this file")
+    parser.add_argument("--min-time", type=float, default=0.5, help="minimum duration of each benchmark (s)")
+    args = parser.parse_args()
+
+    # not connected; only the binding/packet conversions are measured
+    robot = trakr.Robot("127.0.0.1", 0)
+    plan = _plan()
+    state = AlliedDataTypes.State()
+    config = QuadDataTypes.CONFIG_SET()
+
+    benchmarks = [
+        ("BM_Py_SetData", lambda : robot.setData(plan)),
+        ("BM_Py_GetData", lambda : robot.getData(state)),
+        ("BM_Py_SetConfig", lambda : robot.setConfig(config)),
+        ("BM_Py_GetConfig", lambda : robot.getConfig(config)),
+        ("BM_Py_RoundTrip", lambda : (robot.getData(state), robot.setData(plan))),
+    ]
+
+    results = {
+        "context" : {
+            "date" : time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+            "host_name" : platform.node(),
+            "executable" : sys.executable,
+            "python_version" : platform.python_version(),
+        },
+        "benchmarks" : [],
+    }
+
+    for name, fn in benchmarks:
+        result = _measure(name, fn, args.min_time)
+        results["benchmarks"].append(result)
+        print("{:<24}{:>14.1f} ns{:>14}".format(name, result["real_time"], result["iterations"]), file=sys.stderr)
+
+    text = json.dumps(results, indent=2)
+    if(args.out is None):
+        print(text)
+    else:
+        with open(args.out, "w") as f:
+            f.write(text)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
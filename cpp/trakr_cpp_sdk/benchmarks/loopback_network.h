@@ -0,0 +1,102 @@
+/**
+ * @file loopback_network.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief In-process transport of the benchmarks and the allocation check
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef LOOPBACK_NETWORK_H_
+#define LOOPBACK_NETWORK_H_
+
+#include "robot.h"
+
+/**
+ * @brief In-process transport; every read returns the same (brought-up)
+ * state and every write is accepted, so Robot::run() is measured without
+ * sockets. Connected from the start, so that a Robot can be used without
+ * setup().
+ */
+class LoopbackNetwork : public ClientNetworkConfig::ClientNetwork
+{
+    public:
+
+    LoopbackNetwork()
+    {
+        // brought up : Robot::setup() waits for a non-negative status
+        state_.config.status = 0;
+    };
+
+    ~LoopbackNetwork() {};
+
+    /// @brief last plan written
+    const ClientNetworkConfig::AlliedPlan& plan() const
+    {
+        return plan_;
+    }
+
+    bool setup() override
+    {
+        return true;
+    }
+
+    bool connect(const char* ip_addr, const int port) override
+    {
+        (void)ip_addr;
+        (void)port;
+
+        connected_ = true;
+        return true;
+    }
+
+    bool disconnect() override
+    {
+        connected_ = false;
+        return true;
+    }
+
+    bool isConnected() override
+    {
+        return connected_;
+    }
+
+    bool shutdown() override
+    {
+        connected_ = false;
+        return true;
+    }
+
+    bool readData() override
+    {
+        return true;
+    }
+
+    bool getData(ClientNetworkConfig::AlliedState &recv_data) override
+    {
+        recv_data = state_;
+        return true;
+    }
+
+    bool setData(const ClientNetworkConfig::AlliedPlan &send_data) override
+    {
+        plan_ = send_data;
+        return true;
+    }
+
+    bool writeData() override
+    {
+        return true;
+    }
+
+    private:
+
+    bool connected_ = true;
+
+    ClientNetworkConfig::AlliedState state_ {};
+
+    ClientNetworkConfig::AlliedPlan plan_ {};
+};
+
+#endif
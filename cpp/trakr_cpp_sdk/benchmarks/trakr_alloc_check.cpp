@@ -0,0 +1,429 @@
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "robot.h"
+#include "command_mux.h"
+#include "loopback_network.h"
+
+// Heap allocations made by the control thread once warmed up (see README.md)
+//
+// usage : ./bin/trakr_alloc_check [--cycles <n>] [--warmup <n>] [--socket [--port <port>]]
+//   --cycles : checked control cycles, default 20000
+//   --warmup : unchecked cycles first (first trace event, first segment, ...), default 1000
+//   --socket : talk to a local stand-in robot through the real socket
+//              transport instead of the in-process loopback
+//
+// Every malloc family call of the process goes through the hooks below;
+// only calls from the control thread while armed are counted. The check
+// fails (exit code 1) if any cycle allocated, and names the phase.
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* ptr);
+}
+
+/// @brief set on the control thread around the checked calls
+static thread_local bool armed_ = false;
+
+/// @brief allocations seen while armed, and the phase that made the first one
+static thread_local uint64_t allocations_ = 0;
+static thread_local const char* phase_ = "";
+static thread_local const char* first_phase_ = nullptr;
+
+static inline void count_()
+{
+    if(armed_)
+    {
+        allocations_++;
+        if(first_phase_ == nullptr)
+        {
+            first_phase_ = phase_;
+        }
+    }
+}
+
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        count_();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        count_();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        count_();
+        return __libc_realloc(ptr, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        count_();
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        count_();
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** ptr, size_t alignment, size_t size)
+    {
+        count_();
+        *ptr = __libc_memalign(alignment, size);
+        return (*ptr == nullptr) ? ENOMEM : 0;
+    }
+
+    void free(void* ptr)
+    {
+        __libc_free(ptr);
+    }
+}
+
+/**
+ * @brief Scope naming the phase being checked
+ *
+ */
+class Phase
+{
+    public:
+
+    explicit Phase(const char* name)
+    {
+        phase_ = name;
+        armed_ = true;
+    }
+
+    ~Phase()
+    {
+        armed_ = false;
+    }
+};
+
+/**
+ * @brief Stand-in robot streaming brought-up states at 1 kHz and draining
+ * the replies
+ */
+class StandIn
+{
+    public:
+
+    explicit StandIn(int port) : port_(port)
+    {
+    }
+
+    ~StandIn()
+    {
+        running_.store(false);
+        if(thread_.joinable())
+        {
+            thread_.join();
+        }
+        if(listen_fd_ >= 0)
+        {
+            close(listen_fd_);
+        }
+    }
+
+    bool start()
+    {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port_);
+        if((bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+            || (listen(listen_fd_, 1) != 0))
+        {
+            std::cout << "[ALLOC] Failed to listen on port " << port_ << std::endl;
+            return false;
+        }
+
+        running_.store(true);
+        thread_ = std::thread(&StandIn::loop_, this);
+        return true;
+    }
+
+    private:
+
+    int port_;
+
+    int listen_fd_ = -1;
+
+    std::atomic<bool> running_ {false};
+
+    std::thread thread_;
+
+    void loop_()
+    {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if(fd < 0)
+        {
+            return;
+        }
+
+        ClientNetworkConfig::AlliedState state {};
+        state.config.status = 0;
+        char reply[sizeof(ClientNetworkConfig::AlliedPlan)];
+
+        while(running_.load())
+        {
+            if(send(fd, &state, sizeof(state), MSG_NOSIGNAL) != sizeof(state))
+            {
+                break;
+            }
+            while(recv(fd, reply, sizeof(reply), MSG_DONTWAIT) > 0)
+            {
+            }
+            usleep(1000);
+        }
+        close(fd);
+    }
+};
+
+static void removeDirectory_(const std::string &path)
+{
+    DIR* dir = opendir(path.c_str());
+    if(dir != nullptr)
+    {
+        while(struct dirent* entry = readdir(dir))
+        {
+            if(entry->d_name[0] != '.')
+            {
+                unlink((path + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(path.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    int cycles = 20000;
+    int warmup = 1000;
+    bool use_socket = false;
+    int port = 15361;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if((arg == "--cycles") && (i + 1 < argc))
+        {
+            cycles = std::stoi(argv[++i]);
+        }
+        else if((arg == "--warmup") && (i + 1 < argc))
+        {
+            warmup = std::stoi(argv[++i]);
+        }
+        else if(arg == "--socket")
+        {
+            use_socket = true;
+        }
+        else if((arg == "--port") && (i + 1 < argc))
+        {
+            port = std::stoi(argv[++i]);
+        }
+        else
+        {
+            std::cout << "usage : " << argv[0] << " [--cycles <n>] [--warmup <n>] [--socket [--port <port>]]" << std::endl;
+            return 2;
+        }
+    }
+
+    // every optional hot-path feature on, so that all of it is checked
+    Trace::enable();
+    Log::setRateLimit(0.5);
+
+    Metrics::Registry registry;
+    Metrics::LinkMetrics metrics(registry);
+
+    char directory[] = "/tmp/trakr_alloc_check_XXXXXX";
+    if(mkdtemp(directory) == nullptr)
+    {
+        std::cout << "[ALLOC] Failed to create a directory in /tmp" << std::endl;
+        return 2;
+    }
+
+    FlightLog::RecorderConfig recorder_config;
+    recorder_config.directory = directory;
+    recorder_config.segment_size = 4 * 1024 * 1024;
+    recorder_config.max_segments = 1;
+    FlightLog::Recorder recorder(recorder_config);
+    if(!recorder.start())
+    {
+        std::cout << "[ALLOC] Failed to start the recorder in " << directory << std::endl;
+        return 2;
+    }
+
+    LoopbackNetwork loopback;
+    StandIn stand_in(port);
+    std::unique_ptr<Robot> robot;
+    if(use_socket)
+    {
+        if(!stand_in.start())
+        {
+            return 2;
+        }
+        robot.reset(new Robot("127.0.0.1", port));
+    }
+    else
+    {
+        robot.reset(new Robot(loopback));
+    }
+    robot->setMetrics(&metrics);
+    robot->setRecorder(&recorder);
+
+    SharedState::Publisher shared("trakr_alloc_check");
+    if(!shared.open())
+    {
+        std::cout << "[ALLOC] Failed to open the shared state" << std::endl;
+        return 2;
+    }
+    robot->setSharedState(&shared);
+
+    CommandMux mux;
+    const int policy = mux.addSlot("policy", 0, 0.1);
+
+    QuadDataTypes::CONFIG_SET config;
+    AlliedDataTypes::Plan plan;
+    AlliedDataTypes::State state;
+    plan.joint.kp = JointVector::Constant(60.0);
+    plan.joint.kd = JointVector::Constant(2.0);
+    plan.joint.pos = JointVector::Zero();
+    plan.joint.vel = JointVector::Zero();
+    plan.joint.tor = JointVector::Zero();
+    plan.torso.pos = Vector6::Zero();
+    plan.torso.vel = Vector6::Zero();
+
+    if(!robot->setup(config, plan))
+    {
+        std::cout << "[ALLOC] Failed to setup the robot" << std::endl;
+        return 2;
+    }
+
+    uint64_t failed_cycles = 0;
+    const char* failed_phase = nullptr;
+
+    for(int i = 0; i < warmup + cycles; i++)
+    {
+        const bool checked = (i >= warmup);
+        const uint64_t before = allocations_;
+        first_phase_ = nullptr;
+
+        bool ok;
+        {
+            Phase phase(checked ? "Robot::run" : "");
+            ok = robot->run();
+        }
+        if(!ok)
+        {
+            std::cout << "[ALLOC] Robot::run() failed" << std::endl;
+            return 2;
+        }
+
+        if(checked)
+        {
+            Phase phase("Robot::getData");
+            robot->getData(state);
+        }
+        else
+        {
+            robot->getData(state);
+        }
+
+        plan.joint.pos = state.joint.pos;
+        plan.torso.vel(3) = 0.1;
+
+        if(checked)
+        {
+            {
+                Phase phase("Robot::getConfig");
+                robot->getConfig(config);
+                robot->getConfigStatus();
+            }
+            {
+                Phase phase("CommandMux");
+                mux.setData(policy, plan);
+                mux.resolve(plan);
+            }
+            {
+                Phase phase("Robot::setData");
+                robot->setData(plan);
+            }
+            {
+                Phase phase("TRAKR_TRACE_SCOPE");
+                TRAKR_TRACE_SCOPE("user.policy");
+            }
+            {
+                Phase phase("TRAKR_LOG");
+                TRAKR_LOG_WARN("[ALLOC] cycle %d of %s, x = %.3f", i, "loop", plan.torso.vel(3));
+            }
+        }
+        else
+        {
+            robot->getConfig(config);
+            robot->getConfigStatus();
+            mux.setData(policy, plan);
+            mux.resolve(plan);
+            robot->setData(plan);
+            TRAKR_TRACE_SCOPE("user.policy");
+            TRAKR_LOG_WARN("[ALLOC] cycle %d of %s, x = %.3f", i, "loop", plan.torso.vel(3));
+        }
+
+        if(checked && (allocations_ != before))
+        {
+            if(failed_phase == nullptr)
+            {
+                failed_phase = first_phase_;
+            }
+            failed_cycles++;
+        }
+
+        if(use_socket)
+        {
+            usleep(1000);
+        }
+    }
+
+    recorder.stop();
+    removeDirectory_(directory);
+
+    std::cout << "[ALLOC] " << cycles << " cycles checked after " << warmup << " warm-up cycles ("
+              << (use_socket ? "socket" : "loopback") << " transport)" << std::endl;
+    if(failed_cycles > 0)
+    {
+        std::cout << "[ALLOC] FAILED : " << allocations_ << " allocations in " << failed_cycles
+                  << " cycles, first in " << failed_phase << std::endl;
+        return 1;
+    }
+    std::cout << "[ALLOC] PASSED : no allocation on the control thread" << std::endl;
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+
+#include "robot.h"
+#include "loopback_network.h"
+
+// Microbenchmarks of the SDK hot path (see README.md)
+//
+// usage : ./bin/trakr_benchmarks --benchmark_out=results.json --benchmark_out_format=json
+
+static void fillPlan_(AlliedDataTypes::Plan &plan)
+{
+    plan.joint.pos = JointVector::Random();
+    plan.joint.vel = JointVector::Random();
+    plan.joint.tor = JointVector::Random();
+    plan.joint.kp = JointVector::Constant(60.0);
+    plan.joint.kd = JointVector::Constant(2.0);
+
+    plan.torso.pos = Vector6::Random();
+    plan.torso.vel = Vector6::Random();
+}
+
+// dataAdaptor_(AlliedPlan&, Plan&)
+static void BM_SetData(benchmark::State &bm)
+{
+    LoopbackNetwork net;
+    Robot robot(net);
+
+    AlliedDataTypes::Plan plan;
+    fillPlan_(plan);
+
+    for(auto _ : bm)
+    {
+        robot.setData(plan);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_SetData);
+
+// dataAdaptor_(AlliedState&, State&)
+static void BM_GetData(benchmark::State &bm)
+{
+    LoopbackNetwork net;
+    Robot robot(net);
+
+    AlliedDataTypes::State state;
+
+    for(auto _ : bm)
+    {
+        robot.getData(state);
+        benchmark::DoNotOptimize(state);
+    }
+}
+BENCHMARK(BM_GetData);
+
+// dataAdaptor_(AlliedPlan&, CONFIG_SET&)
+static void BM_SetConfig(benchmark::State &bm)
+{
+    LoopbackNetwork net;
+    Robot robot(net);
+
+    QuadDataTypes::CONFIG_SET config;
+
+    for(auto _ : bm)
+    {
+        robot.setConfig(config);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_SetConfig);
+
+// dataAdaptor_(AlliedState&, CONFIG_SET&)
+static void BM_GetConfig(benchmark::State &bm)
+{
+    LoopbackNetwork net;
+    Robot robot(net);
+
+    QuadDataTypes::CONFIG_SET config;
+
+    for(auto _ : bm)
+    {
+        robot.getConfig(config);
+        benchmark::DoNotOptimize(config);
+    }
+}
+BENCHMARK(BM_GetConfig);
+
+// one receive/send cycle over the loopback transport
+static void BM_Run(benchmark::State &bm)
+{
+    LoopbackNetwork net;
+    Robot robot(net);
+
+    for(auto _ : bm)
+    {
+        benchmark::DoNotOptimize(robot.run());
+        benchmark::DoNotOptimize(net.plan());
+    }
+}
+BENCHMARK(BM_Run);
+
+// a full control step as written by users : read, plan, send
+static void BM_ControlStep(benchmark::State &bm)
+{
+    LoopbackNetwork net;
+    Robot robot(net);
+
+    AlliedDataTypes::Plan plan;
+    AlliedDataTypes::State state;
+    fillPlan_(plan);
+
+    for(auto _ : bm)
+    {
+        robot.getData(state);
+        robot.setData(plan);
+        benchmark::DoNotOptimize(robot.run());
+        benchmark::DoNotOptimize(net.plan());
+    }
+}
+BENCHMARK(BM_ControlStep);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,294 @@
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "clock_source.h"
+#include "observation.h"
+#include "shared_state.h"
+#include "triple_buffer.h"
+
+// Torn reads of the lock-free handoffs under a writer that never pauses (see README.md)
+//
+// usage : ./bin/trakr_stress_check [--seconds <s>]
+//   --seconds : time given to each check, default 1
+//
+// For each of TripleBuffer, Observation::History and the SharedState
+// seqlock, one thread writes values that all derive from a counter as
+// fast as it can while the main thread reads them back. Every value read
+// must match the counter it was written with, and counters must never go
+// backwards. The check fails (exit code 1) on the first inconsistent read.
+
+/// @brief counter as a float32 value, exact (below 2^24)
+static float value_(uint64_t n)
+{
+    return static_cast<float>(n & 0xFFFFF);
+}
+
+/// @brief runs write(n), n = 1, 2, ... on its own thread until stop()
+class Writer
+{
+    public:
+
+    template <typename Write>
+    explicit Writer(Write write) : thread_([this, write]()
+        {
+            uint64_t n = 1;
+            while(running_.load(std::memory_order_relaxed))
+            {
+                write(n++);
+            }
+            written_ = n - 1;
+        })
+    {
+    }
+
+    ~Writer()
+    {
+        stop();
+    }
+
+    /// @brief join the writer
+    /// @return values written
+    uint64_t stop()
+    {
+        running_.store(false);
+        if(thread_.joinable())
+        {
+            thread_.join();
+        }
+        return written_;
+    }
+
+    private:
+
+    std::atomic<bool> running_ {true};
+
+    uint64_t written_ = 0;
+
+    std::thread thread_;
+};
+
+/**
+ * @brief Payload of the TripleBuffer check; every value equals seq
+ */
+struct Payload
+{
+    uint64_t seq = 0;
+    uint64_t values[62] {};
+};
+
+static bool checkTripleBuffer_(double seconds)
+{
+    TripleBuffer<Payload> buffer;
+    Writer writer([&buffer](uint64_t n)
+        {
+            Payload &slot = buffer.back();
+            slot.seq = n;
+            for(uint64_t &value : slot.values)
+            {
+                value = n;
+            }
+            buffer.publish();
+        });
+
+    const uint64_t deadline = SystemClock::monotonic() + static_cast<uint64_t>(seconds * 1e9);
+    uint64_t reads = 0;
+    uint64_t fresh = 0;
+    uint64_t last = 0;
+    Payload payload;
+    while(SystemClock::monotonic() < deadline)
+    {
+        const bool updated = buffer.read(payload);
+        reads++;
+        fresh += updated ? 1 : 0;
+
+        for(uint64_t value : payload.values)
+        {
+            if(value != payload.seq)
+            {
+                std::cout << "[STRESS] TripleBuffer : torn value " << value << " in payload " << payload.seq << std::endl;
+                return false;
+            }
+        }
+        if((payload.seq < last) || (updated && (last != 0) && (payload.seq == last)))
+        {
+            std::cout << "[STRESS] TripleBuffer : payload " << payload.seq << " read after " << last << std::endl;
+            return false;
+        }
+        last = payload.seq;
+    }
+
+    const uint64_t written = writer.stop();
+    std::cout << "[STRESS] TripleBuffer : " << reads << " reads (" << fresh << " fresh) of " << written << " writes" << std::endl;
+    return true;
+}
+
+static bool checkHistory_(double seconds)
+{
+    const size_t length = 16;
+    Observation::History history;
+    history.reset(length);
+
+    Writer writer([&history](uint64_t n)
+        {
+            AlliedDataTypes::State state;
+            const double value = value_(n);
+            state.joint.pos.setConstant(value);
+            state.joint.vel.setConstant(value);
+            state.joint.tor.setConstant(value);
+            state.joint.kp.setConstant(value);
+            state.joint.kd.setConstant(value);
+            state.torso.pos.setConstant(value);
+            state.torso.vel.setConstant(value);
+            state.imu.acc.setConstant(value);
+            state.imu.gyro.setConstant(value);
+            state.imu.mag.setConstant(value);
+            state.imu.euler.setConstant(value);
+            state.joint.timestamp = n;
+            history.push(state);
+        });
+
+    const uint64_t deadline = SystemClock::monotonic() + static_cast<uint64_t>(seconds * 1e9);
+    std::vector<float> rows(length * Observation::SIZE);
+    std::vector<uint64_t> stamps(length);
+    uint64_t reads = 0;
+    uint64_t last = 0;
+    while(SystemClock::monotonic() < deadline)
+    {
+        const size_t count = history.copy(rows.data(), stamps.data(), length);
+        reads++;
+
+        for(size_t i = 0; i < count; i++)
+        {
+            if((i > 0) && (stamps[i] != stamps[i - 1] + 1))
+            {
+                std::cout << "[STRESS] History : observation " << stamps[i] << " follows " << stamps[i - 1] << std::endl;
+                return false;
+            }
+            for(size_t k = 0; k < Observation::SIZE; k++)
+            {
+                if(rows[i * Observation::SIZE + k] != value_(stamps[i]))
+                {
+                    std::cout << "[STRESS] History : torn observation " << stamps[i] << " (value " << k << ")" << std::endl;
+                    return false;
+                }
+            }
+        }
+        if(count > 0)
+        {
+            if(stamps[count - 1] < last)
+            {
+                std::cout << "[STRESS] History : observation " << stamps[count - 1] << " read after " << last << std::endl;
+                return false;
+            }
+            last = stamps[count - 1];
+        }
+    }
+
+    const uint64_t written = writer.stop();
+    std::cout << "[STRESS] History : " << reads << " copies of " << written << " pushes" << std::endl;
+    return true;
+}
+
+static bool checkSharedState_(double seconds)
+{
+    SharedState::Publisher publisher("trakr_stress_check");
+    if(!publisher.open())
+    {
+        std::cout << "[STRESS] Failed to open the shared state" << std::endl;
+        return false;
+    }
+    SharedState::Reader reader("trakr_stress_check");
+    if(!reader.open())
+    {
+        return false;
+    }
+
+    Writer writer([&publisher](uint64_t n)
+        {
+            ClientNetworkConfig::AlliedState state {};
+            state.state.joint.pos.fill(value_(n));
+            state.state.joint.vel.fill(value_(n));
+            state.state.joint.tor.fill(value_(n));
+            state.state.joint.timestamp = n;
+            publisher.publish(state, n);
+        });
+
+    const uint64_t deadline = SystemClock::monotonic() + static_cast<uint64_t>(seconds * 1e9);
+    uint64_t reads = 0;
+    uint64_t failed = 0;
+    uint64_t last = 0;
+    ClientNetworkConfig::AlliedState state {};
+    ClientNetworkConfig::AlliedState good {};
+    while(SystemClock::monotonic() < deadline)
+    {
+        uint64_t stamp = 0;
+        const uint64_t count = reader.read(&state, &stamp);
+        reads++;
+
+        if(count == 0)
+        {
+            // no consistent copy : the packet must be left as it was
+            failed++;
+            if(std::memcmp(&state, &good, sizeof(state)) != 0)
+            {
+                std::cout << "[STRESS] SharedState : packet written by a failed read" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        const float value = value_(stamp);
+        for(size_t i = 0; i < state.state.joint.pos.size(); i++)
+        {
+            if((state.state.joint.pos[i] != value) || (state.state.joint.vel[i] != value) || (state.state.joint.tor[i] != value))
+            {
+                std::cout << "[STRESS] SharedState : torn packet " << stamp << std::endl;
+                return false;
+            }
+        }
+        if((count != stamp) || (state.state.joint.timestamp != stamp) || (stamp < last))
+        {
+            std::cout << "[STRESS] SharedState : packet " << stamp << " read as state " << count << " after " << last << std::endl;
+            return false;
+        }
+        last = stamp;
+        good = state;
+    }
+
+    const uint64_t written = writer.stop();
+    std::cout << "[STRESS] SharedState : " << reads << " reads (" << failed << " given up) of " << written << " publishes" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 1.0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if((arg == "--seconds") && (i + 1 < argc))
+        {
+            seconds = std::stod(argv[++i]);
+        }
+        else
+        {
+            std::cout << "usage : " << argv[0] << " [--seconds <s>]" << std::endl;
+            return 2;
+        }
+    }
+
+    const bool ok = checkTripleBuffer_(seconds) && checkHistory_(seconds) && checkSharedState_(seconds);
+    if(!ok)
+    {
+        std::cout << "[STRESS] FAILED" << std::endl;
+        return 1;
+    }
+
+    std::cout << "[STRESS] PASSED : no torn or out of order read" << std::endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <string>
+
+#include "robot.h"
+#include "replay_network.h"
+
+#define FREQ 400
+
+// Replays a flight log (see README.md) through the same loop as basic.cpp
+//
+// usage : ./bin/replay <log> [realtime] [capture_dir]
+//   <log>       : segment file or directory of segments
+//   realtime    : keep the recorded timing (default : lockstep, as fast as possible)
+//   capture_dir : directory to record the replayed states and produced plans in
+
+void doAction(AlliedDataTypes::State &state, AlliedDataTypes::Plan &plan)
+{
+    // controller under test
+    (void)state;
+    (void)plan;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        std::cout << "usage : " << argv[0] << " <log> [realtime] [capture_dir]" << std::endl;
+        return 1;
+    }
+
+    bool realtime = (argc > 2) && (std::string(argv[2]) == "realtime");
+    unsigned long int sleep_ns_ = 1000000000/FREQ;
+
+    FlightLog::ReplayNetwork replay(argv[1], realtime ? FlightLog::ReplayMode::eRealTime : FlightLog::ReplayMode::eLockstep);
+
+    FlightLog::RecorderConfig rec_config;
+    rec_config.directory = (argc > 3) ? argv[3] : ".";
+    rec_config.prefix = "replay";
+
+    FlightLog::Recorder capture(rec_config);
+    if(argc > 3)
+    {
+        if(!capture.start())
+        {
+            return 1;
+        }
+        replay.setCapture(&capture);
+    }
+
+    Robot robot(replay);
+
+    AlliedDataTypes::Plan plan;
+    AlliedDataTypes::State state;
+    QuadDataTypes::CONFIG_SET config;
+
+    plan.joint.kp = JointVector::Zero();
+    plan.joint.kd = JointVector::Zero();
+    plan.joint.pos = JointVector::Zero();
+    plan.joint.vel = JointVector::Zero();
+    plan.joint.tor = JointVector::Zero();
+
+    plan.torso.pos = Vector6::Zero();
+    plan.torso.vel = Vector6::Zero();
+
+    if(!robot.setup(config, plan))
+    {
+        std::cout << "[MAIN] Failed to setup replay" << std::endl;
+        return 1;
+    }
+
+    robot.getConfig(config);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    while(robot.isAlive())
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        if(!robot.run())
+        {
+            break;
+        }
+
+        robot.getData(state);
+        robot.getConfig(config);
+        robot.getConfigStatus();
+
+        doAction(state, plan);
+
+        robot.setData(plan);
+
+        while(realtime && std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(std::chrono::high_resolution_clock::now() - start).count() < sleep_ns_)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(10));
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+    const FlightLog::ReplayStats &stats = replay.stats();
+
+    std::cout << "[REPLAY] states     : " << stats.states << " (" << stats.skipped << " skipped, " << stats.rebased << " rebased) in " << elapsed << " s" << std::endl;
+    std::cout << "[REPLAY] plans      : " << stats.plans << " (" << stats.compared << " compared)" << std::endl;
+    std::cout << "[REPLAY] mismatched : " << stats.mismatched << " (max abs diff " << stats.max_abs_diff << ")" << std::endl;
+
+    capture.stop();
+
+    return 0;
+}
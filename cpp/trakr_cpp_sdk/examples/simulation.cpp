@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "robot.h"
+#include "sim_network.h"
+
+#define FREQ 1000
+
+// Runs a controller against the built-in simulator, faster than real time (see README.md)
+//
+// usage : ./bin/simulation [lowlevel] [duration]
+//   lowlevel : track a joint trajectory (default : walk in high level mode)
+//   duration : simulated seconds, default 600
+
+int main(int argc, char** argv)
+{
+    bool low_level = false;
+    double duration = 600.0;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if(arg == "lowlevel")
+        {
+            low_level = true;
+        }
+        else
+        {
+            duration = std::stod(arg);
+        }
+    }
+
+    Sim::SimParams params;
+    params.step = 1.0 / FREQ;
+    Sim::SimNetwork sim(params);
+
+    Robot robot(sim, low_level ? LOW_LEVEL : HIGH_LEVEL);
+    robot.setClock(&sim.clock());
+
+    AlliedDataTypes::Plan plan;
+    AlliedDataTypes::State state;
+    QuadDataTypes::CONFIG_SET config;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    if(!robot.setup(config, plan))
+    {
+        std::cout << "[MAIN] Failed to setup the simulation" << std::endl;
+        return 1;
+    }
+    robot.getConfig(config);
+
+    if(!low_level)
+    {
+        config.motion.planner = MotionDataTypes::TaskTypes::eMotion;
+        config.motion.strategy.type = MotionModes::eAIMode;
+        config.motion.strategy.seq = MotionGaits::eWalk;
+        robot.setConfig(config);
+    }
+
+    const uint64_t start = robot.clock().now();
+    const uint64_t end = start + static_cast<uint64_t>(duration * 1e9);
+    const uint64_t period = 1000000000 / FREQ;
+    uint64_t next = start;
+    double error = 0.0;
+    uint64_t cycles = 0;
+
+    while(robot.isAlive() && (robot.clock().now() < end))
+    {
+        if(!robot.run())
+        {
+            break;
+        }
+
+        robot.getData(state);
+        robot.getConfigStatus();
+
+        // controller under test
+        const double t = (robot.clock().now() - start) * 1e-9;
+        if(low_level)
+        {
+            error += std::fabs(plan.joint.pos(1) - state.joint.pos(1));
+            plan.joint.kp = JointVector::Constant(80.0);
+            plan.joint.kd = JointVector::Constant(2.0);
+            plan.joint.pos = JointVector::Constant(0.3 * std::sin(2.0 * M_PI * 0.5 * t));
+            plan.joint.vel = JointVector::Constant(0.3 * 2.0 * M_PI * 0.5 * std::cos(2.0 * M_PI * 0.5 * t));
+        }
+        else
+        {
+            plan.torso.vel(2) = 0.1;
+            plan.torso.vel(3) = 0.5;
+        }
+        robot.setData(plan);
+        cycles++;
+
+        next += period;
+        robot.clock().sleepUntil(next);
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+    const double simulated = (robot.clock().now() - start) * 1e-9;
+
+    std::cout << "[SIM] " << simulated << " s simulated in " << elapsed << " s (" << simulated / elapsed
+              << "x real time, " << sim.steps() << " steps)" << std::endl;
+    if(low_level)
+    {
+        std::cout << "[SIM] mean tracking error of joint 1 : " << error / std::max<uint64_t>(cycles, 1) << " rad" << std::endl;
+    }
+    else
+    {
+        std::cout << "[SIM] torso at x " << state.torso.pos(3) << " m, y " << state.torso.pos(4)
+                  << " m, yaw " << state.torso.pos(2) << " rad" << std::endl;
+    }
+    return 0;
+}
@@ -18,8 +18,15 @@
 #include <iostream>
 
 #include "trakr_sdk.h"
+#include "socket_network.h"
 #include "quad_config.h"
 #include "allied_data_types.h"
+#include "flight_recorder.h"
+#include "shared_state.h"
+#include "trace.h"
+#include "logger.h"
+#include "metrics.h"
+#include "clock_source.h"
 
 typedef Eigen::Matrix<double, NDOF, 1> JointVector;
 typedef Eigen::Matrix<double, 6, 1> Vector6;
@@ -40,14 +47,25 @@ class Robot
         ip_addr_ = ip_addr;
         port_ = port;
         mode_ = mode;
+        net_ = &socket_;
+    };
+
+    /// @brief Robot over a different transport (replay, simulation, ...)
+    /// @param net transport, owned by the caller and outliving the Robot
+    Robot(ClientNetworkConfig::ClientNetwork &net, int mode = HIGH_LEVEL)
+    {
+        ip_addr_ = "";
+        port_ = 0;
+        mode_ = mode;
+        net_ = &net;
     };
 
     /// @brief Shutdown network before destructing
     ~Robot()
     {
-        if(net_.isConnected())
+        if(net_->isConnected())
         {
-            net_.shutdown();
+            net_->shutdown();
         }
     }
 
@@ -59,7 +77,7 @@ class Robot
     /// @return 
     bool isAlive()
     {
-        return net_.isConnected();
+        return net_->isConnected();
     }
 
     bool setData(AlliedDataTypes::Plan &plan);
@@ -72,6 +90,39 @@ class Robot
 
     int getConfigStatus();
 
+    /// @brief record every packet exchanged in run() (nullptr to detach)
+    /// @param recorder started recorder, owned by the caller
+    void setRecorder(FlightLog::Recorder *recorder)
+    {
+        recorder_ = recorder;
+    }
+
+    /// @brief publish every state received in run() to local processes (nullptr to detach)
+    /// @param shared opened publisher, owned by the caller
+    void setSharedState(SharedState::Publisher *shared)
+    {
+        shared_ = shared;
+    }
+
+    /// @brief update loop and link metrics in run() (nullptr to detach)
+    /// @param metrics owned by the caller, updated from the thread calling run()
+    void setMetrics(Metrics::LinkMetrics *metrics)
+    {
+        metrics_ = metrics;
+    }
+
+    /// @brief clock of the waits in setup() and of RobotRunner (nullptr for the system clock)
+    /// @param clock owned by the caller, e.g. the clock of a simulated transport
+    void setClock(ClockSource *clock)
+    {
+        clock_ = (clock != nullptr) ? clock : &SystemClock::instance();
+    }
+
+    ClockSource& clock()
+    {
+        return *clock_;
+    }
+
     private :
 
     const char* ip_addr_;
@@ -81,7 +132,10 @@ class Robot
     int mode_;
 
     /// @brief Main robot network for communication
-    ClientNetworkConfig::RobotNetwork net_;
+    ClientNetworkConfig::SocketNetwork socket_;
+
+    /// @brief Transport in use; socket_ unless one was given
+    ClientNetworkConfig::ClientNetwork *net_;
 
     /// @brief Local buffer to send data
     ClientNetworkConfig::AlliedPlan plan_;
@@ -95,6 +149,18 @@ class Robot
     /// @brief Response for last "setConfig" action
     int config_status_;
 
+    /// @brief Optional flight recorder, not owned
+    FlightLog::Recorder *recorder_ = nullptr;
+
+    /// @brief Optional shared-memory publisher, not owned
+    SharedState::Publisher *shared_ = nullptr;
+
+    /// @brief Optional metrics, not owned
+    Metrics::LinkMetrics *metrics_ = nullptr;
+
+    /// @brief Clock of the waits, not owned
+    ClockSource *clock_ = &SystemClock::instance();
+
     void dataAdaptor_(ClientNetworkConfig::AlliedPlan &send, AlliedDataTypes::Plan &plan);
 
     void dataAdaptor_(ClientNetworkConfig::AlliedPlan &send, QuadDataTypes::CONFIG_SET &config);
@@ -103,6 +169,8 @@ class Robot
 
     void dataAdaptor_(ClientNetworkConfig::AlliedState &recv, QuadDataTypes::CONFIG_SET &config);
 
+    bool exchange_();
+
     bool bringUp_();
 
     bool setMode_(QuadDataTypes::CONFIG_SET &config);
@@ -0,0 +1,180 @@
+/**
+ * @file robot_runner.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Robot exchanged with from a dedicated thread
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef ROBOT_RUNNER_H_
+#define ROBOT_RUNNER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "robot.h"
+#include "observation.h"
+#include "command_mux.h"
+#include "triple_buffer.h"
+
+/**
+ * @brief Runs Robot::run() from its own thread at a fixed rate, so that a
+ * slow or paused caller (a Python policy, a garbage collection) never
+ * stalls the link with the robot. The caller only pushes plans and pulls
+ * states; every accessor is wait-free.
+ *
+ * The setters are to be called from one thread at a time, and so are the
+ * getters.
+ */
+class RobotRunner
+{
+    public :
+
+    /// @param rate exchange rate (Hz)
+    RobotRunner(const char* ip_addr, const int port, int mode = HIGH_LEVEL, double rate = 1000.0)
+    : ip_addr_(ip_addr), robot_(ip_addr_.c_str(), port, mode), rate_(rate)
+    {
+    };
+
+    /// @brief runner over a different transport (replay, simulation, ...)
+    RobotRunner(ClientNetworkConfig::ClientNetwork &net, int mode = HIGH_LEVEL, double rate = 1000.0)
+    : robot_(net, mode), rate_(rate)
+    {
+    };
+
+    /// @brief stop the thread before the robot shuts the network down
+    ~RobotRunner()
+    {
+        stop();
+        if(notify_fd_ >= 0)
+        {
+            close(notify_fd_);
+        }
+    }
+
+    bool start(QuadDataTypes::CONFIG_SET &config, AlliedDataTypes::Plan &plan);
+
+    void stop();
+
+    /// @brief return whether the thread is exchanging with the robot
+    bool isAlive() const
+    {
+        return alive_.load(std::memory_order_relaxed);
+    }
+
+    void setData(const AlliedDataTypes::Plan &plan);
+
+    bool getData(AlliedDataTypes::State &state);
+
+    bool getObservation(float* out);
+
+    bool setHistory(size_t length);
+
+    int openNotifyFd();
+
+    bool publishState(const std::string &name);
+
+    bool setCommandMux(CommandMux *mux);
+
+    /// @brief last observations, oldest first (see Observation::History::copy)
+    size_t getHistory(float* rows, uint64_t* stamps, size_t count) const
+    {
+        return history_.copy(rows, stamps, count);
+    }
+
+    uint64_t setConfig(const QuadDataTypes::CONFIG_SET &config);
+
+    /// @brief ticket of the last configuration sent by the thread; a status
+    /// read after it reached a ticket answers that configuration (or a later one)
+    uint64_t configTicket() const
+    {
+        return config_ticket_.load(std::memory_order_acquire);
+    }
+
+    void getConfig(QuadDataTypes::CONFIG_SET &config);
+
+    int getConfigStatus();
+
+    /// @brief cycles run, and cycles that ended past their deadline
+    uint64_t cycles() const
+    {
+        return cycles_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t overruns() const
+    {
+        return overruns_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief underlying robot, to attach a recorder or metrics before start()
+    Robot& robot()
+    {
+        return robot_;
+    }
+
+    private :
+
+    /// @brief kept here, as Robot keeps a pointer to it
+    std::string ip_addr_;
+
+    Robot robot_;
+
+    double rate_;
+
+    std::thread thread_;
+
+    std::atomic<bool> running_ {false};
+
+    std::atomic<bool> alive_ {false};
+
+    /// @brief latest plan from the caller, state and config from the robot
+    TripleBuffer<AlliedDataTypes::Plan> plan_;
+    TripleBuffer<AlliedDataTypes::State> state_;
+    TripleBuffer<QuadDataTypes::CONFIG_SET> config_;
+
+    /// @brief observations of every state received, if enabled
+    Observation::History history_;
+
+    /// @brief shared-memory segment of the states, if published
+    std::unique_ptr<SharedState::Publisher> shared_;
+
+    /// @brief producers arbitrated every cycle, if attached
+    CommandMux* mux_ = nullptr;
+
+    /// @brief eventfd signalled after every cycle, -1 unless opened
+    int notify_fd_ = -1;
+
+    struct ConfigRequest
+    {
+        QuadDataTypes::CONFIG_SET config;
+        uint64_t ticket = 0;
+    };
+
+    /// @brief configuration to be sent, once
+    TripleBuffer<ConfigRequest> config_request_;
+
+    /// @brief tickets given by setConfig(), and the last one sent
+    uint64_t config_tickets_ = 0;
+    std::atomic<uint64_t> config_ticket_ {0};
+
+    /// @brief robot's answer to the last configuration, until read
+    std::atomic<int> config_status_ {0};
+
+    std::atomic<uint64_t> cycles_ {0};
+
+    std::atomic<uint64_t> overruns_ {0};
+
+    /// @brief used by the thread only
+    AlliedDataTypes::Plan plan_local_;
+    QuadDataTypes::CONFIG_SET config_local_;
+
+    void loop_();
+
+    void notify_();
+};
+
+#endif
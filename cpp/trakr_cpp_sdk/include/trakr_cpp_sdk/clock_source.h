@@ -0,0 +1,67 @@
+/**
+ * @file clock_source.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Time and waits of Robot and RobotRunner, real or simulated
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef CLOCK_SOURCE_H_
+#define CLOCK_SOURCE_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Clock that Robot waits on during the bring-up and mode switch,
+ * and RobotRunner paces its cycles with. SystemClock (the default) is the
+ * monotonic clock; a simulated transport provides its own (Sim::SimClock)
+ * so that waits cost no real time.
+ */
+class ClockSource
+{
+    public :
+
+    virtual ~ClockSource()
+    {
+    }
+
+    /// @brief time (ns)
+    virtual uint64_t now() = 0;
+
+    /// @brief wait until now() reaches deadline (ns)
+    virtual void sleepUntil(uint64_t deadline) = 0;
+
+    /// @brief wait for duration (ns)
+    void sleep(uint64_t duration)
+    {
+        sleepUntil(now() + duration);
+    }
+};
+
+class SystemClock : public ClockSource
+{
+    public :
+
+    /// @brief CLOCK_MONOTONIC (ns), read through the vDSO (no syscall); the
+    /// one time base of the SDK's stamps (log, trace, metrics, recorder)
+    static uint64_t monotonic()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+    }
+
+    /// @brief monotonic()
+    uint64_t now() override;
+
+    /// @brief clock_nanosleep() to the absolute deadline
+    void sleepUntil(uint64_t deadline) override;
+
+    /// @brief shared instance, the default of Robot
+    static SystemClock& instance();
+};
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * @file column_store.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Columnar, memory-mappable export of recorded sessions
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef COLUMN_STORE_H_
+#define COLUMN_STORE_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "packet_fields.h"
+
+/**
+ * @brief Transposes a flight log into one contiguous array per channel.
+ *
+ * One row per recorded AlliedState, with the AlliedPlan sent in response
+ * to it (the first plan recorded after the state).
+ *
+ * File layout :
+ *  FileHeader
+ *  ColumnDesc x ncolumns
+ *  column data, each column contiguous and 64-byte aligned
+ *
+ * Columns : "stamp" (uint64, local receive time in ns; the timestamp
+ * index), "plan_stamp" (uint64, 0 if no plan followed), "session" (int32,
+ * incremented where the stamps go backwards, i.e. a recorder session
+ * after a reboot, as directories hold every session), then every field of
+ * PacketFields::stateFields() and planFields(), with the config fields
+ * prefixed "state." and "plan." respectively. "stamp" is non-decreasing
+ * within a session only.
+ */
+namespace ColumnStore
+{
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr size_t NAME_SIZE = 56;
+    constexpr size_t ALIGNMENT = 64;
+
+    struct FileHeader
+    {
+        char magic[8] = {'T', 'R', 'K', 'R', 'C', 'O', 'L', '\0'};
+        uint32_t version = FILE_VERSION;
+        uint32_t columns = 0;
+        uint64_t rows = 0;
+
+        /// @brief wall-clock/monotonic reference of the recording (ns)
+        uint64_t wall_ns = 0;
+        uint64_t mono_ns = 0;
+    };
+
+    struct ColumnDesc
+    {
+        char name[NAME_SIZE] = {0};
+        uint32_t type = 0;
+        uint32_t elem_size = 0;
+
+        /// @brief byte offset of the column from the start of the file
+        uint64_t offset = 0;
+    };
+
+    /// @brief FieldType of the columns viewed as T
+    template <typename T>
+    struct FieldTypeOf;
+
+    template <>
+    struct FieldTypeOf<float>
+    {
+        static constexpr PacketFields::FieldType value = PacketFields::FieldType::eFloat32;
+    };
+
+    template <>
+    struct FieldTypeOf<uint64_t>
+    {
+        static constexpr PacketFields::FieldType value = PacketFields::FieldType::eUInt64;
+    };
+
+    template <>
+    struct FieldTypeOf<int32_t>
+    {
+        static constexpr PacketFields::FieldType value = PacketFields::FieldType::eInt32;
+    };
+
+    template <>
+    struct FieldTypeOf<bool>
+    {
+        static constexpr PacketFields::FieldType value = PacketFields::FieldType::eBool;
+    };
+
+    /// @brief typed view over a mapped column
+    template <typename T>
+    struct Column
+    {
+        const T* data = nullptr;
+        size_t size = 0;
+
+        const T& operator[](size_t i) const
+        {
+            return data[i];
+        }
+
+        bool valid() const
+        {
+            return data != nullptr;
+        }
+    };
+
+    /// @brief convert a flight log (segment file or directory) into a column file
+    /// @return
+    bool exportLog(const std::string &log_path, const std::string &out_path);
+
+    class Reader
+    {
+        public:
+
+        Reader() {};
+
+        ~Reader();
+
+        /// @brief map the file; column data is only paged in when accessed
+        /// @return
+        bool open(const std::string &path);
+
+        void close();
+
+        size_t rows() const
+        {
+            return header_.rows;
+        }
+
+        const FileHeader& header() const
+        {
+            return header_;
+        }
+
+        const std::vector<ColumnDesc>& columns() const
+        {
+            return columns_;
+        }
+
+        /// @brief typed view of a column; invalid if missing or of another type
+        template <typename T>
+        Column<T> column(const std::string &name) const
+        {
+            Column<T> col;
+            const ColumnDesc* desc = find_(name);
+            if((desc != nullptr) && (desc->elem_size == sizeof(T))
+                && (desc->type == static_cast<uint32_t>(FieldTypeOf<T>::value)))
+            {
+                col.data = reinterpret_cast<const T*>(map_ + desc->offset);
+                col.size = header_.rows;
+            }
+            return col;
+        }
+
+        /// @brief first row of the session received at or after the stamp
+        /// (binary search over "stamp", sorted within a session only)
+        /// @return a row of the session, or the end of the session if none
+        size_t lowerBound(uint64_t stamp, int32_t session = 0) const;
+
+        private:
+
+        const unsigned char* map_ = nullptr;
+
+        size_t size_ = 0;
+
+        FileHeader header_;
+
+        std::vector<ColumnDesc> columns_;
+
+        const ColumnDesc* find_(const std::string &name) const;
+    };
+};
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file command_mux.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Arbitration between several producers of plans
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef COMMAND_MUX_H_
+#define COMMAND_MUX_H_
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+#include "allied_data_types.h"
+#include "triple_buffer.h"
+
+/**
+ * @brief Named input slots for plans (teleop, autonomy, safety supervisor,
+ * ...), each with a priority and a timeout, written by one producer thread
+ * each through its own TripleBuffer. The control thread resolves the
+ * winner every cycle : the live command (set, not released, not older than
+ * its timeout) of highest priority. Neither side locks or allocates, and
+ * resolve() visits at most MAX_SLOTS slots.
+ *
+ * Slots are added before the producers and the control thread start.
+ */
+class CommandMux
+{
+    public :
+
+    static constexpr int MAX_SLOTS = 8;
+
+    CommandMux()
+    {
+    }
+
+    /// @brief add an input; ties of priority go to the slot added first
+    /// @param timeout a command older than this (s) is ignored, 0 for never
+    /// @return index of the slot, -1 if MAX_SLOTS are taken
+    int addSlot(const std::string &name, int priority, double timeout);
+
+    /// @brief index of a slot, -1 if none is named so
+    int slot(const std::string &name) const;
+
+    const std::string& name(int slot) const
+    {
+        return slots_[slot].name;
+    }
+
+    int slots() const
+    {
+        return count_;
+    }
+
+    /// @brief command of a slot, from now on (the slot's producer only)
+    void setData(int slot, const AlliedDataTypes::Plan &plan);
+
+    /// @brief withdraw the command of a slot (the slot's producer only)
+    void release(int slot);
+
+    /// @brief copy the winning command into plan (control thread only)
+    /// @param now FlightLog::now()
+    /// @return slot of the winner, -1 if no command is live (plan untouched)
+    int resolve(AlliedDataTypes::Plan &plan, uint64_t now);
+
+    int resolve(AlliedDataTypes::Plan &plan);
+
+    /// @brief winner of the last resolve(), -1 if none
+    int winner() const
+    {
+        return winner_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief times the winner changed
+    uint64_t switches() const
+    {
+        return switches_.load(std::memory_order_relaxed);
+    }
+
+    private :
+
+    struct Command
+    {
+        AlliedDataTypes::Plan plan;
+
+        /// @brief FlightLog::now() when set, 0 if released
+        uint64_t stamp = 0;
+    };
+
+    struct Slot
+    {
+        std::string name;
+
+        int priority = 0;
+
+        /// @brief 0 for never
+        uint64_t timeout_ns = 0;
+
+        TripleBuffer<Command> command;
+    };
+
+    std::array<Slot, MAX_SLOTS> slots_;
+
+    /// @brief slots by decreasing priority
+    std::array<int, MAX_SLOTS> order_ {};
+
+    int count_ = 0;
+
+    std::atomic<int> winner_ {-1};
+
+    std::atomic<uint64_t> switches_ {0};
+};
+
+#endif
@@ -0,0 +1,296 @@
+/**
+ * @file flight_recorder.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Binary flight recorder for the packets exchanged with robot
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef FLIGHT_RECORDER_H_
+#define FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <type_traits>
+#include <stdint.h>
+
+#include "trakr_sdk.h"
+#include "spsc_queue.h"
+
+/**
+ * @brief Records every AlliedState received and every AlliedPlan sent
+ * into rotating, memory-mapped segment files.
+ *
+ * Segment layout : SegmentHeader followed by back-to-back records, each
+ * a RecordHeader followed by the raw packet (padded to 8 bytes). A
+ * zeroed RecordHeader marks the end of a segment.
+ *
+ * With RecorderConfig::compress, segments are written as compressed .trz
+ * files instead (see log_codec.h); the Reader accepts both.
+ */
+namespace LogCodec
+{
+    class Writer;
+    class Reader;
+};
+
+namespace FlightLog
+{
+    static_assert(std::is_trivially_copyable<ClientNetworkConfig::AlliedState>::value, "AlliedState must be trivially copyable");
+    static_assert(std::is_trivially_copyable<ClientNetworkConfig::AlliedPlan>::value, "AlliedPlan must be trivially copyable");
+
+    constexpr uint32_t SEGMENT_VERSION = 1;
+    constexpr uint32_t RECORD_MAGIC = 0x5452434bu; // "TRCK"
+
+    enum class RecordType : uint16_t
+    {
+        eNone = 0,
+        eState = 1,
+        ePlan = 2,
+    };
+
+    struct SegmentHeader
+    {
+        char magic[8] = {'T', 'R', 'K', 'R', 'L', 'O', 'G', '\0'};
+        uint32_t version = SEGMENT_VERSION;
+        uint32_t index = 0;
+
+        /// @brief packet sizes, to reject logs from a different SDK build
+        uint32_t state_size = sizeof(ClientNetworkConfig::AlliedState);
+        uint32_t plan_size = sizeof(ClientNetworkConfig::AlliedPlan);
+
+        /// @brief wall-clock and monotonic time at segment creation (ns),
+        /// to map record stamps (monotonic) onto wall-clock time
+        uint64_t wall_ns = 0;
+        uint64_t mono_ns = 0;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t magic = 0;
+        uint16_t type = 0;
+        uint16_t size = 0;
+
+        /// @brief running count of records pushed by the control thread
+        uint64_t seq = 0;
+
+        /// @brief local monotonic receive/send time (ns)
+        uint64_t stamp = 0;
+    };
+
+    /// @brief one decoded record as returned by the Reader
+    struct Entry
+    {
+        RecordType type = RecordType::eNone;
+        uint64_t seq = 0;
+        uint64_t stamp = 0;
+
+        /// @brief valid if type == RecordType::eState
+        ClientNetworkConfig::AlliedState state;
+
+        /// @brief valid if type == RecordType::ePlan
+        ClientNetworkConfig::AlliedPlan plan;
+    };
+
+    struct RecorderConfig
+    {
+        /// @brief directory receiving the segment files (must exist)
+        std::string directory = ".";
+
+        /// @brief segment file names are <prefix>_<index>.trlog (.trz if compressed)
+        std::string prefix = "trakr";
+
+        /// @brief preallocated size of each segment (bytes), or size
+        /// reached before rotating a compressed segment
+        size_t segment_size = 64 * 1024 * 1024;
+
+        /// @brief oldest segments are deleted beyond this count
+        int max_segments = 16;
+
+        /// @brief interval between flushes of the mapped segment to disk
+        int fsync_period_ms = 1000;
+
+        /// @brief interval between attempts to open a segment after a failure
+        int retry_period_ms = 1000;
+
+        /// @brief slots in the control thread -> writer queue
+        size_t queue_capacity = 8192;
+
+        /// @brief write compressed segments, for long recordings
+        bool compress = false;
+
+        /// @brief records per independently decodable block (compressed only)
+        uint32_t block_records = 1024;
+    };
+
+    /// @brief monotonic time (ns) used for record stamps, SystemClock::monotonic()
+    uint64_t now();
+
+    class Recorder
+    {
+        public:
+
+        explicit Recorder(const RecorderConfig &config = RecorderConfig());
+
+        /// @brief stops the writer thread and flushes pending records
+        ~Recorder();
+
+        /// @brief open the first segment and start the writer thread;
+        /// numbering continues after the segments already in the directory
+        /// @return
+        bool start();
+
+        /// @brief drain the queue, flush and close the current segment
+        void stop();
+
+        /// @brief queue a received packet (control thread only, never blocks)
+        /// @return false if the queue was full and the record was dropped
+        bool recordState(const ClientNetworkConfig::AlliedState &state, uint64_t stamp);
+
+        /// @brief queue a sent packet (control thread only, never blocks)
+        /// @return false if the queue was full and the record was dropped
+        bool recordPlan(const ClientNetworkConfig::AlliedPlan &plan, uint64_t stamp);
+
+        /// @brief records lost to a full queue
+        uint64_t dropped() const
+        {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+        /// @brief records written into segments
+        uint64_t written() const
+        {
+            return written_.load(std::memory_order_relaxed);
+        }
+
+        /// @brief records lost because no segment could be opened (disk full, permissions)
+        uint64_t failed() const
+        {
+            return failed_.load(std::memory_order_relaxed);
+        }
+
+        private:
+
+        static constexpr size_t MAX_PAYLOAD =
+            sizeof(ClientNetworkConfig::AlliedState) > sizeof(ClientNetworkConfig::AlliedPlan) ?
+            sizeof(ClientNetworkConfig::AlliedState) : sizeof(ClientNetworkConfig::AlliedPlan);
+
+        struct Slot
+        {
+            RecordHeader header;
+            unsigned char payload[MAX_PAYLOAD];
+        };
+
+        RecorderConfig config_;
+
+        SpscQueue<Slot> queue_;
+
+        std::thread writer_;
+
+        std::atomic<bool> running_ {false};
+
+        std::atomic<uint64_t> dropped_ {0};
+
+        std::atomic<uint64_t> written_ {0};
+
+        std::atomic<uint64_t> failed_ {0};
+
+        /// @brief monotonic time (ns) before which no segment open is retried (writer thread only)
+        uint64_t retry_at_ = 0;
+
+        /// @brief sequence counter owned by the control thread
+        uint64_t seq_ = 0;
+
+        /// @brief current segment (writer thread only)
+        int fd_ = -1;
+        unsigned char* map_ = nullptr;
+        size_t offset_ = 0;
+        size_t synced_ = 0;
+        uint32_t index_ = 0;
+
+        /// @brief segments on disk, oldest first, previous sessions' included
+        std::deque<std::string> segments_;
+
+        /// @brief encoder of the current segment, if compressed
+        std::unique_ptr<LogCodec::Writer> codec_;
+
+        bool push_(RecordType type, const void* data, size_t size, uint64_t stamp);
+
+        void writerLoop_();
+
+        bool drain_();
+
+        bool append_(const Slot &slot);
+
+        bool rotate_();
+
+        void scanSegments_();
+
+        bool openSegment_();
+
+        void addSegment_(const std::string &path);
+
+        void closeSegment_();
+
+        void sync_();
+    };
+
+    class Reader
+    {
+        public:
+
+        Reader();
+
+        ~Reader();
+
+        /// @brief open a single segment file, or the segments
+        /// <prefix>_<index>.trlog/.trz of a directory in index order
+        /// @param prefix recorder prefix; empty takes the one of the first
+        /// segment (by name), segments of other prefixes are skipped
+        /// @return false if nothing readable was found
+        bool open(const std::string &path, const std::string &prefix = "");
+
+        /// @brief read the next record, in recording order
+        /// @return false at the end of the log
+        bool next(Entry &entry);
+
+        /// @brief segment files, in the order they will be read
+        const std::vector<std::string>& segments() const
+        {
+            return files_;
+        }
+
+        /// @brief header of the segment being read
+        const SegmentHeader& header() const
+        {
+            return header_;
+        }
+
+        private:
+
+        std::vector<std::string> files_;
+
+        SegmentHeader header_;
+
+        size_t file_ = 0;
+
+        const unsigned char* map_ = nullptr;
+        size_t size_ = 0;
+        size_t offset_ = 0;
+
+        /// @brief decoder of the current segment, if compressed
+        std::unique_ptr<LogCodec::Reader> codec_;
+
+        bool openSegment_(const std::string &path);
+
+        void closeSegment_();
+    };
+};
+
+#endif
@@ -0,0 +1,238 @@
+/**
+ * @file log_codec.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Compressed encoding of flight logs (.trz)
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef LOG_CODEC_H_
+#define LOG_CODEC_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "flight_recorder.h"
+#include "packet_fields.h"
+
+/**
+ * @brief Lossless compression of the flight log records.
+ *
+ * File layout : FileHeader, then independent blocks of up to
+ * block_records records, each a BlockHeader followed by a bit stream.
+ * Predictors are reset at every block, so any block can be decoded on
+ * its own (random access by time through the block headers).
+ *
+ * Per record :
+ *  - record type (1 bit) and sequence delta (1 bit when contiguous)
+ *  - local stamp, as delta-of-delta per record type
+ *  - config, raw and only when it differs from the last one of that type
+ *  - float channels, XOR against the previous value (Gorilla)
+ *  - timestamp channels, as delta-of-delta
+ */
+namespace LogCodec
+{
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BLOCK_MAGIC = 0x4b4c4254u; // "TBLK"
+
+    struct FileHeader
+    {
+        char magic[8] = {'T', 'R', 'K', 'R', 'L', 'O', 'G', 'Z'};
+        uint32_t version = FILE_VERSION;
+        uint32_t block_records = 0;
+
+        uint32_t state_size = sizeof(ClientNetworkConfig::AlliedState);
+        uint32_t plan_size = sizeof(ClientNetworkConfig::AlliedPlan);
+
+        /// @brief wall-clock/monotonic reference of the recording (ns)
+        uint64_t wall_ns = 0;
+        uint64_t mono_ns = 0;
+    };
+
+    struct BlockHeader
+    {
+        uint32_t magic = BLOCK_MAGIC;
+        uint32_t records = 0;
+        uint64_t first_stamp = 0;
+        uint64_t last_stamp = 0;
+
+        /// @brief size of the bit stream following the header
+        uint32_t bytes = 0;
+        uint32_t reserved = 0;
+    };
+
+    /// @brief location of a block inside the file
+    struct BlockInfo
+    {
+        size_t offset = 0;
+        uint32_t records = 0;
+        uint32_t bytes = 0;
+        uint64_t first_stamp = 0;
+        uint64_t last_stamp = 0;
+    };
+
+    /**
+     * @brief Prediction state shared by encoder and decoder
+     *
+     */
+    class Predictor
+    {
+        public:
+
+        Predictor();
+
+        /// @brief forget all history (start of a block)
+        void reset();
+
+        protected:
+
+        struct Channel
+        {
+            uint64_t prev = 0;
+            uint64_t delta = 0;
+            int lead = 0;
+            int trail = 0;
+            bool window = false;
+        };
+
+        /// @brief per record type : 0 state, 1 plan
+        struct Stream
+        {
+            /// @brief packet channels outside the config
+            std::vector<PacketFields::Field> fields;
+            std::vector<Channel> channels;
+
+            /// @brief byte offset and size of the config inside the packet
+            size_t config_offset = 0;
+            size_t config_size = 0;
+            std::vector<unsigned char> config;
+            bool has_config = false;
+
+            uint64_t stamp = 0;
+            uint64_t stamp_delta = 0;
+        };
+
+        Stream streams_[2];
+
+        uint64_t seq_ = 0;
+    };
+
+    class Writer : public Predictor
+    {
+        public:
+
+        Writer() {};
+
+        ~Writer();
+
+        /// @param block_records records per independently decodable block
+        /// @return
+        bool open(const std::string &path, uint32_t block_records = 1024,
+                  uint64_t wall_ns = 0, uint64_t mono_ns = 0);
+
+        /// @brief encode one record
+        /// @param packet raw AlliedState (eState) or AlliedPlan (ePlan)
+        /// @return
+        bool write(FlightLog::RecordType type, const void* packet, uint64_t seq, uint64_t stamp);
+
+        bool write(const FlightLog::Entry &entry);
+
+        /// @brief write the pending block to the file (and optionally to disk)
+        bool flush(bool sync = false);
+
+        /// @brief flush and close
+        void close();
+
+        /// @brief bytes written to the file so far
+        size_t bytes() const
+        {
+            return bytes_;
+        }
+
+        private:
+
+        FILE* file_ = nullptr;
+
+        uint32_t block_records_ = 0;
+
+        BlockHeader block_;
+
+        /// @brief bit stream of the pending block
+        std::vector<unsigned char> buf_;
+        uint64_t acc_ = 0;
+        int bits_ = 0;
+
+        size_t bytes_ = 0;
+
+        void put_(uint64_t value, int bits);
+
+        void putInt_(uint64_t value);
+
+        void putFloat_(Channel &ch, uint32_t value);
+    };
+
+    class Reader : public Predictor
+    {
+        public:
+
+        Reader() {};
+
+        ~Reader();
+
+        /// @brief map the file and index its blocks
+        /// @return
+        bool open(const std::string &path);
+
+        void close();
+
+        /// @brief decode the next record
+        /// @return false at the end of the file
+        bool next(FlightLog::Entry &entry);
+
+        /// @brief continue reading from the block holding the stamp
+        /// @return false if the stamp is past the end of the file
+        bool seek(uint64_t stamp);
+
+        const FileHeader& header() const
+        {
+            return header_;
+        }
+
+        const std::vector<BlockInfo>& blocks() const
+        {
+            return blocks_;
+        }
+
+        private:
+
+        const unsigned char* map_ = nullptr;
+        size_t size_ = 0;
+
+        FileHeader header_;
+
+        std::vector<BlockInfo> blocks_;
+
+        /// @brief block being decoded
+        size_t block_ = 0;
+        uint32_t remaining_ = 0;
+        const unsigned char* data_ = nullptr;
+        size_t data_size_ = 0;
+        size_t pos_ = 0;
+        uint64_t acc_ = 0;
+        int bits_ = 0;
+
+        bool startBlock_(size_t index);
+
+        uint64_t get_(int bits);
+
+        uint64_t getInt_();
+
+        uint32_t getFloat_(Channel &ch);
+    };
+};
+
+#endif
@@ -0,0 +1,257 @@
+/**
+ * @file logger.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Asynchronous logger with deferred formatting
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Logging that never blocks the calling thread.
+ *
+ * A log call copies its format string pointer and arguments into a ring
+ * owned by the calling thread (no formatting, no lock, no syscall); a
+ * background thread formats the records and hands them to the sink
+ * (stdout by default). When a ring is full the record is dropped and
+ * counted. Each call site is rate limited, so a message repeated every
+ * cycle ("Socket disconnected") is printed at most once per interval,
+ * followed by the number of repeats suppressed.
+ *
+ *  TRAKR_LOG_WARN("[ROBOT] Joint %d over limit : %.3f", i, pos);
+ *
+ * The format must be a string literal using printf conversions; string
+ * arguments are copied, truncated to Log::TEXT_SIZE bytes in total.
+ */
+namespace Log
+{
+    enum Level : uint8_t
+    {
+        eDebug = 0,
+        eInfo = 1,
+        eWarn = 2,
+        eError = 3,
+        eOff = 4
+    };
+
+    /// @brief arguments kept per record
+    static constexpr int MAX_ARGS = 8;
+
+    /// @brief bytes kept for the string arguments of a record
+    static constexpr int TEXT_SIZE = 96;
+
+    /// @brief one argument, stored by value
+    struct Arg
+    {
+        enum Type : uint8_t {eInt, eUint, eDouble, eText, ePointer};
+
+        Type type;
+
+        union
+        {
+            int64_t i;
+            uint64_t u;
+            double d;
+            uint16_t text;          // offset into Record::text
+            const void* p;
+        };
+    };
+
+    /**
+     * @brief State of a call site, for rate limiting
+     *
+     */
+    struct Site
+    {
+        /// @brief monotonic time (ns) the site may print again
+        std::atomic<uint64_t> next {0};
+
+        /// @brief calls suppressed since the last printed one
+        std::atomic<uint32_t> suppressed {0};
+    };
+
+    /// @brief a log call, formatted later by the background thread
+    struct Record
+    {
+        uint64_t seq;
+        uint64_t stamp;
+        const char* format;
+        uint32_t suppressed;
+        Level level;
+        uint8_t count;
+        uint16_t text_size;
+        Arg args[MAX_ARGS];
+        char text[TEXT_SIZE];
+    };
+
+    extern std::atomic<uint8_t> level_;
+
+    extern std::atomic<uint64_t> rate_limit_;
+
+    /// @brief records below this level are discarded at the call site
+    void setLevel(Level level);
+
+    inline bool isEnabled(Level level)
+    {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief minimum interval (s) between two prints of a call site; 0 disables
+    void setRateLimit(double seconds);
+
+    /// @brief replace the sink (default : stdout, one line per record),
+    /// called from the background thread only
+    void setSink(std::function<void(Level, const char*)> sink);
+
+    /// @brief block until every record logged so far reached the sink
+    void flush();
+
+    /// @brief records lost to full rings
+    uint64_t dropped();
+
+    /// @brief monotonic time (ns), SystemClock::monotonic()
+    uint64_t now();
+
+    /// @brief reserve a record in the calling thread's ring
+    /// @return nullptr if the ring is full (the record is counted as dropped)
+    Record* beginRecord_();
+
+    /// @brief publish the record returned by beginRecord_()
+    void endRecord_();
+
+    /**
+     * @brief Capture of the arguments into a record
+     *
+     */
+    inline void capture_(Record &record, const char* text)
+    {
+        Arg &arg = record.args[record.count++];
+        arg.type = Arg::eText;
+        if(record.text_size >= TEXT_SIZE)
+        {
+            // text is full; its last byte is a terminator
+            arg.text = TEXT_SIZE - 1;
+            return;
+        }
+        arg.text = record.text_size;
+
+        const char* source = (text != nullptr) ? text : "(null)";
+        size_t length = strnlen(source, TEXT_SIZE);
+        length = std::min<size_t>(length, TEXT_SIZE - 1 - record.text_size);
+        memcpy(record.text + record.text_size, source, length);
+        record.text_size += length;
+        record.text[record.text_size++] = '\0';
+    }
+
+    inline void capture_(Record &record, char* text)
+    {
+        capture_(record, static_cast<const char*>(text));
+    }
+
+    inline void capture_(Record &record, const std::string &text)
+    {
+        capture_(record, text.c_str());
+    }
+
+    inline void capture_(Record &record, const void* pointer)
+    {
+        Arg &arg = record.args[record.count++];
+        arg.type = Arg::ePointer;
+        arg.p = pointer;
+    }
+
+    template <typename T>
+    inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+    capture_(Record &record, T value)
+    {
+        Arg &arg = record.args[record.count++];
+        if(std::is_floating_point<T>::value)
+        {
+            arg.type = Arg::eDouble;
+            arg.d = static_cast<double>(value);
+        }
+        else if(std::is_signed<T>::value || std::is_enum<T>::value)
+        {
+            arg.type = Arg::eInt;
+            arg.i = static_cast<int64_t>(value);
+        }
+        else
+        {
+            arg.type = Arg::eUint;
+            arg.u = static_cast<uint64_t>(value);
+        }
+    }
+
+    inline void captureAll_(Record &)
+    {
+    }
+
+    template <typename T, typename... Rest>
+    inline void captureAll_(Record &record, const T &value, const Rest&... rest)
+    {
+        capture_(record, value);
+        captureAll_(record, rest...);
+    }
+
+    /// @brief rate limit, then queue the record
+    template <typename... Args>
+    void write(Site &site, Level level, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+
+        const uint64_t stamp = now();
+        const uint64_t limit = rate_limit_.load(std::memory_order_relaxed);
+        if(limit > 0)
+        {
+            uint64_t next = site.next.load(std::memory_order_relaxed);
+            if((stamp < next) || !site.next.compare_exchange_strong(next, stamp + limit, std::memory_order_relaxed))
+            {
+                site.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        Record* record = beginRecord_();
+        if(record == nullptr)
+        {
+            return;
+        }
+        record->stamp = stamp;
+        record->format = format;
+        record->level = level;
+        record->suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        record->count = 0;
+        record->text_size = 0;
+        captureAll_(*record, args...);
+        endRecord_();
+    }
+};
+
+#define TRAKR_LOG(level, ...)                                       \
+    do                                                              \
+    {                                                               \
+        if(Log::isEnabled(level))                                   \
+        {                                                           \
+            static Log::Site trakr_log_site_;                       \
+            Log::write(trakr_log_site_, level, __VA_ARGS__);        \
+        }                                                           \
+    } while(0)
+
+#define TRAKR_LOG_DEBUG(...) TRAKR_LOG(Log::eDebug, __VA_ARGS__)
+#define TRAKR_LOG_INFO(...) TRAKR_LOG(Log::eInfo, __VA_ARGS__)
+#define TRAKR_LOG_WARN(...) TRAKR_LOG(Log::eWarn, __VA_ARGS__)
+#define TRAKR_LOG_ERROR(...) TRAKR_LOG(Log::eError, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,372 @@
+/**
+ * @file metrics.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Counters, gauges and histograms with Prometheus exporters
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "clock_source.h"
+
+/**
+ * @brief Loop health and link statistics.
+ *
+ * Metrics are created once in a Registry (setup time, under a lock) and
+ * then updated with relaxed atomics only, so the control thread never
+ * waits on an exporter. Exporters run on their own thread and read the
+ * atomics to render the Prometheus text format.
+ *
+ *  Metrics::Registry registry;
+ *  Metrics::LinkMetrics link(registry, "robot=\"trakr-01\"");
+ *  robot.setMetrics(&link);
+ *
+ *  Metrics::HttpExporter http(registry, "127.0.0.1:9105");
+ *  http.start();
+ */
+namespace Metrics
+{
+    /// @brief monotonic time (ns), SystemClock::monotonic()
+    inline uint64_t now()
+    {
+        return SystemClock::monotonic();
+    }
+
+    /// @brief name, help text and labels shared by every metric type
+    struct Info
+    {
+        std::string name;
+        std::string help;
+
+        /// @brief Prometheus label pairs without braces, e.g. robot="a"
+        std::string labels;
+    };
+
+    /**
+     * @brief Monotonically increasing count
+     *
+     */
+    class Counter
+    {
+        public:
+
+        explicit Counter(const Info &info) : info_(info)
+        {
+        }
+
+        void inc(uint64_t n = 1)
+        {
+            value_.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const
+        {
+            return value_.load(std::memory_order_relaxed);
+        }
+
+        const Info& info() const
+        {
+            return info_;
+        }
+
+        private:
+
+        Info info_;
+
+        std::atomic<uint64_t> value_ {0};
+    };
+
+    /**
+     * @brief Value that can go up and down
+     *
+     */
+    class Gauge
+    {
+        public:
+
+        explicit Gauge(const Info &info) : info_(info)
+        {
+        }
+
+        void set(double value)
+        {
+            value_.store(value, std::memory_order_relaxed);
+        }
+
+        double value() const
+        {
+            return value_.load(std::memory_order_relaxed);
+        }
+
+        const Info& info() const
+        {
+            return info_;
+        }
+
+        private:
+
+        Info info_;
+
+        std::atomic<double> value_ {0.0};
+    };
+
+    /**
+     * @brief Distribution over fixed buckets (upper bounds, ascending)
+     *
+     */
+    class Histogram
+    {
+        public:
+
+        Histogram(const Info &info, const std::vector<double> &bounds);
+
+        /// @brief count one observation; buckets are searched linearly
+        void observe(double value)
+        {
+            size_t i = 0;
+            while((i < bounds_.size()) && (value > bounds_[i]))
+            {
+                i++;
+            }
+            buckets_[i].fetch_add(1, std::memory_order_relaxed);
+
+            double sum = sum_.load(std::memory_order_relaxed);
+            while(!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        const std::vector<double>& bounds() const
+        {
+            return bounds_;
+        }
+
+        /// @brief observations in bucket i (not cumulative); the last
+        /// bucket holds everything above the largest bound
+        uint64_t bucket(size_t i) const
+        {
+            return buckets_[i].load(std::memory_order_relaxed);
+        }
+
+        double sum() const
+        {
+            return sum_.load(std::memory_order_relaxed);
+        }
+
+        const Info& info() const
+        {
+            return info_;
+        }
+
+        private:
+
+        Info info_;
+
+        std::vector<double> bounds_;
+
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+
+        std::atomic<double> sum_ {0.0};
+    };
+
+    /// @brief buckets (s) spanning a 1 kHz loop: 50 us to 100 ms
+    std::vector<double> latencyBuckets();
+
+    /**
+     * @brief Owns every metric; the references it returns stay valid
+     * for its lifetime
+     *
+     */
+    class Registry
+    {
+        public:
+
+        /// @brief find or create; same name and labels give the same metric
+        Counter& counter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+        Gauge& gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+
+        Histogram& histogram(const std::string &name, const std::string &help, const std::string &labels = "",
+                             const std::vector<double> &bounds = latencyBuckets());
+
+        /// @brief render every metric in Prometheus text format 0.0.4
+        void writePrometheus(std::string &out) const;
+
+        private:
+
+        mutable std::mutex mutex_;
+
+        /// @brief type of each metric, in registration order
+        enum Type {eCounter, eGauge, eHistogram};
+
+        struct Entry
+        {
+            Type type;
+            size_t index;
+        };
+
+        std::vector<Entry> order_;
+
+        std::vector<std::unique_ptr<Counter>> counters_;
+
+        std::vector<std::unique_ptr<Gauge>> gauges_;
+
+        std::vector<std::unique_ptr<Histogram>> histograms_;
+
+        const Info& info_(const Entry &entry) const;
+    };
+
+    /**
+     * @brief Metrics of one Robot, updated from Robot::run()
+     *
+     */
+    struct LinkMetrics
+    {
+        /// @param labels identifies the robot, e.g. robot="192.168.1.5"
+        /// @param deadline cycle period (s) above which a deadline counts as missed
+        LinkMetrics(Registry &registry, const std::string &labels = "", double deadline = 0.0025);
+
+        Counter &cycles;
+        Counter &failures;
+        Counter &deadline_misses;
+        Counter &packets_received;
+        Counter &packets_sent;
+        Counter &handshakes_ok;
+        Counter &handshakes_failed;
+        Counter &configs_accepted;
+        Counter &configs_rejected;
+        Gauge &connected;
+
+        /// @brief time between consecutive run() calls
+        Histogram &cycle_period;
+
+        /// @brief time between consecutive states from the robot
+        Histogram &state_interval;
+
+        /// @brief time spent inside run()
+        Histogram &cycle_time;
+
+        double deadline;
+
+        /// @brief written by the control thread only
+        uint64_t last_cycle = 0;
+        uint64_t last_state = 0;
+    };
+
+    /**
+     * @brief Publishes a Registry from its own thread
+     *
+     */
+    class Exporter
+    {
+        public:
+
+        explicit Exporter(const Registry &registry) : registry_(registry)
+        {
+        }
+
+        virtual ~Exporter();
+
+        /// @brief start the exporting thread
+        /// @return false if the exporter could not be opened
+        bool start();
+
+        /// @brief stop and join the exporting thread
+        void stop();
+
+        protected:
+
+        const Registry &registry_;
+
+        std::atomic<bool> running_ {false};
+
+        /// @brief acquire resources, on the caller's thread
+        virtual bool open_() = 0;
+
+        /// @brief exporting loop; returns once running_ is cleared
+        virtual void loop_() = 0;
+
+        /// @brief release resources, after the thread was joined
+        virtual void close_() = 0;
+
+        private:
+
+        std::thread thread_;
+    };
+
+    /**
+     * @brief Rewrites a file with the Prometheus text at a fixed period,
+     * atomically (e.g. for the node_exporter textfile collector)
+     *
+     */
+    class FileExporter : public Exporter
+    {
+        public:
+
+        FileExporter(const Registry &registry, const std::string &path, double period = 1.0)
+            : Exporter(registry), path_(path), period_(period)
+        {
+        }
+
+        ~FileExporter();
+
+        private:
+
+        std::string path_;
+
+        double period_;
+
+        bool open_() override;
+
+        void loop_() override;
+
+        void close_() override;
+
+        bool dump_(std::string &text);
+    };
+
+    /**
+     * @brief Serves the Prometheus text over HTTP, on a TCP address
+     * ("127.0.0.1:9105") or a Unix socket path ("/run/trakr.sock")
+     *
+     */
+    class HttpExporter : public Exporter
+    {
+        public:
+
+        HttpExporter(const Registry &registry, const std::string &address)
+            : Exporter(registry), address_(address)
+        {
+        }
+
+        ~HttpExporter();
+
+        private:
+
+        std::string address_;
+
+        int fd_ = -1;
+
+        bool open_() override;
+
+        void loop_() override;
+
+        void close_() override;
+
+        void serve_(int client, std::string &text);
+    };
+};
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file observation.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Flat float32 observation of a State, and a history of them
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef OBSERVATION_H_
+#define OBSERVATION_H_
+
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "allied_data_types.h"
+#include "comm_config.h"
+
+/**
+ * @brief The continuous data of an AlliedDataTypes::State packed into one
+ * float32 vector, laid out as FIELDS (joint pos, vel, tor, kp, kd, torso
+ * pos, vel, imu acc, gyro, mag, euler), so that a policy gets its whole
+ * input with one copy.
+ */
+namespace Observation
+{
+    struct Field
+    {
+        const char* name;
+
+        /// @brief index of the first value, and number of values
+        size_t offset;
+        size_t size;
+    };
+
+    static constexpr size_t FIELD_COUNT = 11;
+
+    extern const Field FIELDS[FIELD_COUNT];
+
+    /// @brief float32 values per observation : 5 joint fields of NDOF, 2
+    /// torso fields of 6 and 4 imu fields of 3
+    static constexpr size_t SIZE = 5 * NDOF + 2 * 6 + 4 * 3;
+
+    /// @brief write the SIZE values of state into out
+    void pack(const AlliedDataTypes::State &state, float* out);
+
+    /**
+     * @brief Last observations, written by one thread and copied out by
+     * another without locking. Storage is allocated by reset(), so push()
+     * never allocates.
+     */
+    class History
+    {
+        public:
+
+        History()
+        {
+        }
+
+        /// @brief keep the last length observations, dropping the others (not while pushing)
+        void reset(size_t length);
+
+        /// @brief observations kept
+        size_t length() const
+        {
+            return capacity_ > 0 ? capacity_ - 1 : 0;
+        }
+
+        /// @brief append the observation of state (writer only)
+        void push(const AlliedDataTypes::State &state);
+
+        /// @brief copy up to count of the latest observations, oldest first (reader only)
+        /// @param rows count * SIZE values
+        /// @param stamps count joint timestamps, or nullptr
+        /// @return number of observations copied
+        size_t copy(float* rows, uint64_t* stamps, size_t count) const;
+
+        private:
+
+        /// @brief one slot more than length(), as the slot being written is never read
+        size_t capacity_ = 0;
+
+        std::vector<float> rows_;
+
+        std::vector<uint64_t> stamps_;
+
+        /// @brief observations pushed so far
+        std::atomic<uint64_t> count_ {0};
+    };
+};
+
+#endif
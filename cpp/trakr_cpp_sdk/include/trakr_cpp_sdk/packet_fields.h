@@ -0,0 +1,55 @@
+/**
+ * @file packet_fields.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Flat description of the scalar channels of AlliedState/AlliedPlan
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef PACKET_FIELDS_H_
+#define PACKET_FIELDS_H_
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trakr_sdk.h"
+
+/**
+ * @brief Every scalar of a packet as (name, type, byte offset), so that
+ * tools can walk packets generically instead of naming each member.
+ * Arrays are expanded per element, e.g. "joint.tor.7".
+ */
+namespace PacketFields
+{
+    enum class FieldType : uint32_t
+    {
+        eFloat32 = 0,
+        eUInt64 = 1,
+        eInt32 = 2,
+        eBool = 3,
+    };
+
+    struct Field
+    {
+        std::string name;
+        FieldType type;
+
+        /// @brief byte offset inside the packet
+        size_t offset;
+    };
+
+    /// @brief size in bytes of a scalar of the given type
+    size_t typeSize(FieldType type);
+
+    /// @brief channels of ClientNetworkConfig::AlliedState (state.* then config.*)
+    const std::vector<Field>& stateFields();
+
+    /// @brief channels of ClientNetworkConfig::AlliedPlan (plan.* then config.*)
+    const std::vector<Field>& planFields();
+};
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file replay_network.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Transport replaying recorded AlliedState streams into Robot
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef REPLAY_NETWORK_H_
+#define REPLAY_NETWORK_H_
+
+#include <string>
+
+#include "socket_network.h"
+#include "flight_recorder.h"
+
+namespace FlightLog
+{
+    /// @brief gap between consecutive recorded states (ns) beyond which
+    /// eRealTime restarts its pacing instead of replaying the idle time
+    constexpr uint64_t REPLAY_MAX_GAP = 1000000000ull;
+
+    enum class ReplayMode
+    {
+        /// @brief states become available with their recorded inter-arrival times
+        eRealTime,
+
+        /// @brief every readData() delivers the next recorded state
+        eLockstep,
+    };
+
+    /// @brief comparison of the replayed plans against the recorded ones
+    struct ReplayStats
+    {
+        /// @brief states delivered to the client
+        uint64_t states = 0;
+
+        /// @brief recorded states skipped because the client fell behind (eRealTime)
+        uint64_t skipped = 0;
+
+        /// @brief pacing restarts at a stamp going backwards (another session,
+        /// after a reboot) or jumping by more than REPLAY_MAX_GAP (eRealTime)
+        uint64_t rebased = 0;
+
+        /// @brief plans written by the client
+        uint64_t plans = 0;
+
+        /// @brief plans compared against a recorded plan
+        uint64_t compared = 0;
+
+        /// @brief compared plans differing from the recording
+        uint64_t mismatched = 0;
+
+        /// @brief largest absolute difference over all plan channels
+        double max_abs_diff = 0;
+    };
+
+    /**
+     * @brief Feeds the AlliedStates of a flight log to an unmodified Robot
+     * and captures the AlliedPlans it produces.
+     *
+     * Usage : Robot robot(replay); robot.setup(config, plan); ...
+     */
+    class ReplayNetwork : public ClientNetworkConfig::ClientNetwork
+    {
+        public:
+
+        /// @param path segment file or directory, as for Reader::open()
+        /// @param mode eRealTime or eLockstep
+        ReplayNetwork(const std::string &path, ReplayMode mode = ReplayMode::eLockstep);
+
+        ~ReplayNetwork() {};
+
+        /// @brief also write every replayed state and produced plan into a
+        /// flight log, to be diffed later (nullptr to disable)
+        /// @param recorder started recorder, owned by the caller
+        void setCapture(Recorder *recorder)
+        {
+            capture_ = recorder;
+        }
+
+        /// @brief tolerance below which plan channels are considered equal
+        void setTolerance(double tolerance)
+        {
+            tolerance_ = tolerance;
+        }
+
+        const ReplayStats& stats() const
+        {
+            return stats_;
+        }
+
+        /// @brief true once every recorded state has been delivered
+        bool finished() const
+        {
+            return finished_;
+        }
+
+        bool setup() override;
+
+        /// @brief starts the replay clock; address is ignored
+        bool connect(const char* ip_addr, const int port) override;
+
+        bool disconnect() override;
+
+        /// @brief false once the log is exhausted, ending the user loop
+        bool isConnected() override;
+
+        bool shutdown() override;
+
+        bool readData() override;
+
+        bool getData(ClientNetworkConfig::AlliedState &recv_data) override;
+
+        bool setData(const ClientNetworkConfig::AlliedPlan &send_data) override;
+
+        bool writeData() override;
+
+        private:
+
+        std::string path_;
+
+        ReplayMode mode_;
+
+        Reader reader_;
+
+        Recorder *capture_ = nullptr;
+
+        ReplayStats stats_;
+
+        double tolerance_ = 1e-6;
+
+        bool connected_ = false;
+
+        bool finished_ = false;
+
+        /// @brief next recorded state not yet delivered, and the plan recorded after it
+        Entry next_;
+        Entry next_plan_;
+        bool has_next_ = false;
+        bool has_next_plan_ = false;
+
+        /// @brief entry read ahead while looking for the recorded plan
+        Entry lookahead_;
+        bool has_lookahead_ = false;
+
+        /// @brief state delivered to the client, and the plan recorded in response
+        ClientNetworkConfig::AlliedState state_;
+        uint64_t state_stamp_ = 0;
+        ClientNetworkConfig::AlliedPlan recorded_plan_;
+        bool has_recorded_plan_ = false;
+
+        /// @brief plan set by the client
+        ClientNetworkConfig::AlliedPlan plan_;
+
+        /// @brief replay clock : recorded stamp of the first state and local start
+        uint64_t first_stamp_ = 0;
+        uint64_t start_ = 0;
+
+        bool fetch_();
+
+        void deliver_();
+
+        bool discontinuous_() const;
+
+        void compare_();
+    };
+};
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file shared_command.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Commands of one local controller passed to the process owning the link
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef SHARED_COMMAND_H_
+#define SHARED_COMMAND_H_
+
+#include <atomic>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "allied_data_types.h"
+#include "quad_config.h"
+
+/**
+ * @brief Counterpart of SharedState : the process owning the link with the
+ * robot (Server, e.g. trakr_broker) creates a named POSIX shared-memory
+ * segment (/dev/shm/<name>, owner-only), into which a single local
+ * controller writes its latest plan and configuration. The controller
+ * holds an exclusive flock() on the segment, so that a second one is
+ * refused until the first exits (or dies).
+ *
+ * Segment layout : Header, then at RECORD_OFFSET the Record, guarded by
+ * Header::seq (odd while written). The server answers configurations in
+ * Header::answer. Records are copied as bytes : the fixed-size Eigen
+ * members hold their values inline, and record_size rejects other builds.
+ */
+namespace SharedCommand
+{
+    constexpr uint32_t VERSION = 1;
+
+    constexpr size_t RECORD_OFFSET = 64;
+
+    struct Record
+    {
+        /// @brief controller's FlightLog::now() when written
+        uint64_t stamp = 0;
+
+        /// @brief raised by the controller for each configuration to apply
+        uint64_t config_ticket = 0;
+
+        AlliedDataTypes::Plan plan;
+
+        QuadDataTypes::CONFIG_SET config;
+    };
+
+    struct Header
+    {
+        char magic[8] = {'T', 'R', 'K', 'R', 'C', 'M', 'D', '\0'};
+        uint32_t version = VERSION;
+        uint32_t record_size = sizeof(Record);
+
+        std::atomic<uint64_t> seq {0};
+
+        /// @brief server's answer to the last configuration : ticket * 16 + status
+        std::atomic<uint64_t> answer {0};
+
+        /// @brief pids of the server, and of the controller (0 : none)
+        std::atomic<int64_t> server {0};
+        std::atomic<int64_t> controller {0};
+    };
+
+    static_assert(sizeof(Header) <= RECORD_OFFSET, "the header must fit before the record");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "seq must be lock-free to be shared between processes");
+
+    class Server
+    {
+        public:
+
+        explicit Server(const std::string &name = "trakr_command");
+
+        /// @brief unmaps and removes the segment
+        ~Server();
+
+        /// @brief create (or take over) the segment
+        bool open();
+
+        /// @brief copy the record out if a controller wrote it since the last call;
+        /// never waits on the controller (a record being written is read next time)
+        bool read(Record &record);
+
+        /// @brief answer the configuration of ticket (1 sent, 2 accepted, 3 rejected)
+        void answer(uint64_t ticket, int status);
+
+        /// @brief pid of the attached controller, 0 if none
+        pid_t controller() const;
+
+        /// @brief configuration ticket of the record found by open(), already applied
+        uint64_t configTicket() const
+        {
+            return config_ticket_;
+        }
+
+        private:
+
+        std::string name_;
+
+        unsigned char* map_ = nullptr;
+
+        Header* header_ = nullptr;
+
+        /// @brief seq of the last record read
+        uint64_t seq_ = 0;
+
+        uint64_t config_ticket_ = 0;
+    };
+
+    class Controller
+    {
+        public:
+
+        explicit Controller(const std::string &name = "trakr_command");
+
+        /// @brief detaches
+        ~Controller();
+
+        /// @brief map the segment of a running server, and become its controller
+        bool open();
+
+        void close();
+
+        /// @brief return whether the server still serves the segment
+        bool isAlive() const;
+
+        /// @brief plan to be sent from the next cycle on
+        void setData(const AlliedDataTypes::Plan &plan);
+
+        /// @brief configuration to be sent once
+        /// @return its ticket (see configStatus())
+        uint64_t setConfig(const QuadDataTypes::CONFIG_SET &config);
+
+        /// @brief server's answer to the configuration of ticket : 0 pending
+        /// (or superseded), 1 sent, 2 accepted, 3 rejected
+        int configStatus(uint64_t ticket) const;
+
+        private:
+
+        std::string name_;
+
+        int fd_ = -1;
+
+        unsigned char* map_ = nullptr;
+
+        Header* header_ = nullptr;
+
+        /// @brief last record written
+        Record record_;
+
+        void write_();
+    };
+};
+
+#endif
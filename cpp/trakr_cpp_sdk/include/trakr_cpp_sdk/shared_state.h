@@ -0,0 +1,151 @@
+/**
+ * @file shared_state.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Latest AlliedState shared with local processes through shared memory
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef SHARED_STATE_H_
+#define SHARED_STATE_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trakr_sdk.h"
+#include "packet_fields.h"
+
+/**
+ * @brief The process owning the link with the robot publishes every
+ * AlliedState received into a named POSIX shared-memory segment
+ * (/dev/shm/<name>); any number of local processes map it and copy the
+ * latest state out, guarded by a sequence lock, without system calls or
+ * touching the link.
+ *
+ * Segment layout : Header, then field_count FieldEntry (the channels of
+ * PacketFields::stateFields(), so that readers need no knowledge of the
+ * packet), then at record_offset the stamp (uint64) followed by the packet.
+ * Header::seq is odd while the record is being written, and counts two
+ * per state published.
+ */
+namespace SharedState
+{
+    constexpr uint32_t VERSION = 1;
+
+    /// @brief sequence reads of Reader::read() before it gives up
+    constexpr int READ_ATTEMPTS = 256;
+
+    struct Header
+    {
+        char magic[8] = {'T', 'R', 'K', 'R', 'S', 'H', 'M', '\0'};
+        uint32_t version = VERSION;
+        uint32_t field_count = 0;
+
+        /// @brief offset of the record, and size of the packet in it
+        uint64_t record_offset = 0;
+        uint64_t packet_size = 0;
+
+        std::atomic<uint64_t> seq {0};
+    };
+
+    struct FieldEntry
+    {
+        char name[56] = {};
+        uint32_t type = 0;
+        uint32_t offset = 0;
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "seq must be lock-free to be shared between processes");
+
+    /// @brief shm_open() name of a segment ("/<name>")
+    std::string segmentName(const std::string &name);
+
+    class Publisher
+    {
+        public:
+
+        explicit Publisher(const std::string &name = "trakr_state");
+
+        /// @brief unmaps and removes the segment
+        ~Publisher();
+
+        /// @brief create (or take over) the segment
+        bool open();
+
+        /// @brief copy a received packet into the segment (control thread only)
+        void publish(const ClientNetworkConfig::AlliedState &state, uint64_t stamp);
+
+        private:
+
+        std::string name_;
+
+        unsigned char* map_ = nullptr;
+
+        size_t size_ = 0;
+
+        Header* header_ = nullptr;
+
+        unsigned char* record_ = nullptr;
+    };
+
+    class Reader
+    {
+        public:
+
+        explicit Reader(const std::string &name = "trakr_state");
+
+        ~Reader();
+
+        /// @brief map the segment of a running publisher
+        bool open();
+
+        /// @brief copy the latest packet out, retried at most READ_ATTEMPTS
+        /// times while the publisher writes it
+        /// @param packet packetSize() bytes
+        /// @param stamp receive time (FlightLog::now()), or nullptr
+        /// @return states published so far; 0 if none yet or if no
+        /// consistent copy was made (the publisher stopped mid-write, or kept
+        /// overwriting it), the packet being left untouched in both cases
+        uint64_t read(void* packet, uint64_t* stamp = nullptr) const;
+
+        /// @brief states published so far, without copying
+        uint64_t count() const;
+
+        size_t packetSize() const
+        {
+            return packet_size_;
+        }
+
+        /// @brief channels of the packet, as described by the segment
+        const std::vector<PacketFields::Field>& fields() const
+        {
+            return fields_;
+        }
+
+        private:
+
+        std::string name_;
+
+        const unsigned char* map_ = nullptr;
+
+        size_t size_ = 0;
+
+        const Header* header_ = nullptr;
+
+        const unsigned char* record_ = nullptr;
+
+        size_t packet_size_ = 0;
+
+        /// @brief copy being checked against the sequence (sized in open())
+        mutable std::vector<unsigned char> scratch_;
+
+        std::vector<PacketFields::Field> fields_;
+    };
+};
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file sim_network.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Transport simulating the robot in lockstep with Robot
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef SIM_NETWORK_H_
+#define SIM_NETWORK_H_
+
+#include <array>
+#include <atomic>
+#include <stdint.h>
+
+#include "socket_network.h"
+#include "clock_source.h"
+
+namespace Sim
+{
+    /**
+     * @brief Simulated time, advanced by SimNetwork by one step per
+     * exchange; waits return at once, so that Robot and RobotRunner run
+     * as fast as the host allows.
+     */
+    class SimClock : public ClockSource
+    {
+        public:
+
+        uint64_t now() override
+        {
+            return now_.load(std::memory_order_acquire);
+        }
+
+        void sleepUntil(uint64_t deadline) override
+        {
+            (void)deadline;
+        }
+
+        void advance(uint64_t duration)
+        {
+            now_.fetch_add(duration, std::memory_order_release);
+        }
+
+        private:
+
+        std::atomic<uint64_t> now_ {0};
+    };
+
+    struct SimParams
+    {
+        /// @brief simulated time per exchange (s), and integration substeps in it
+        double step = 0.001;
+        int substeps = 4;
+
+        /// @brief reflected inertia (kg m^2), viscous friction (N m s/rad) and torque limit (N m) of every joint
+        double inertia = 0.05;
+        double damping = 0.05;
+        double tor_limit = 45.0;
+
+        /// @brief joint positions held in high level mode, and the gains holding them
+        std::array<double, NDOF> stance = {0.0, 0.8, -1.6, 0.0, 0.8, -1.6, 0.0, 0.8, -1.6, 0.0, 0.8, -1.6};
+        double stance_kp = 60.0;
+        double stance_kd = 2.0;
+
+        /// @brief time constant (s) of the torso tracking the commanded velocity in high level mode
+        double torso_lag = 0.15;
+
+        /// @brief torso height (m)
+        double height = 0.32;
+    };
+
+    /**
+     * @brief Stand-in robot behind ClientNetwork, stepped once per
+     * Robot::run() : writeData() integrates the plan just sent over one
+     * step, and the next readData() delivers the resulting state.
+     *
+     * Low level mode (planner eMotion, strategy eDeveloperMode, as set by
+     * Robot in LOW_LEVEL) tracks the joint commands through
+     * tau = kp (pos - q) + kd (vel - dq) + tor on joints of the given
+     * inertia and friction; otherwise the joints hold the stance and, with
+     * planner eMotion, the torso follows plan.torso.vel (yaw rate, forward,
+     * lateral) on flat ground. The IMU reports gravity and the torso
+     * motion. Every configuration requested is accepted.
+     *
+     * Usage : Sim::SimNetwork sim; Robot robot(sim, mode); robot.setClock(&sim.clock()); ...
+     */
+    class SimNetwork : public ClientNetworkConfig::ClientNetwork
+    {
+        public:
+
+        explicit SimNetwork(const SimParams &params = SimParams());
+
+        ~SimNetwork() {};
+
+        /// @brief clock advanced by the simulation, for Robot::setClock()
+        SimClock& clock()
+        {
+            return clock_;
+        }
+
+        /// @brief steps simulated so far
+        uint64_t steps() const
+        {
+            return steps_;
+        }
+
+        /// @brief return whether the joints track the plan (low level mode)
+        bool lowLevel() const;
+
+        bool setup() override;
+
+        /// @brief resets the robot to the stance; address is ignored
+        bool connect(const char* ip_addr, const int port) override;
+
+        bool disconnect() override;
+
+        bool isConnected() override;
+
+        bool shutdown() override;
+
+        /// @brief true once per step
+        bool readData() override;
+
+        bool getData(ClientNetworkConfig::AlliedState &recv_data) override;
+
+        bool setData(const ClientNetworkConfig::AlliedPlan &send_data) override;
+
+        /// @brief simulate one step under the plan set
+        bool writeData() override;
+
+        private:
+
+        SimParams params_;
+
+        SimClock clock_;
+
+        bool connected_ = false;
+
+        /// @brief state not yet read
+        bool fresh_ = false;
+
+        uint64_t steps_ = 0;
+
+        ClientNetworkConfig::AlliedPlan plan_;
+
+        ClientNetworkConfig::AlliedState state_;
+
+        /// @brief status answered in the next state, and whether the pending request was answered
+        int answer_ = 0;
+        bool answered_ = false;
+
+        /// @brief joint positions, velocities and applied torques
+        std::array<double, NDOF> q_ {};
+        std::array<double, NDOF> dq_ {};
+        std::array<double, NDOF> tau_ {};
+
+        /// @brief torso pose (x, y, yaw) in the world, and velocity (forward, lateral, yaw rate) in its frame
+        double x_ = 0.0, y_ = 0.0, yaw_ = 0.0;
+        double vx_ = 0.0, vy_ = 0.0, wz_ = 0.0;
+
+        /// @brief torso acceleration in its frame, for the IMU
+        double ax_ = 0.0, ay_ = 0.0;
+
+        void configure_();
+
+        void step_();
+
+        void fill_();
+    };
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file socket_network.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief RobotNetwork exposed through the generic NetworkInterface
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef SOCKET_NETWORK_H_
+#define SOCKET_NETWORK_H_
+
+#include "trakr_sdk.h"
+
+namespace ClientNetworkConfig
+{
+    /// @brief Network as seen by the client (sends plans, receives states)
+    typedef NetworkInterface<AlliedPlan, AlliedState> ClientNetwork;
+
+    /**
+     * @brief Default transport of Robot; the socket connection to the
+     * robot, so that other transports (replay, simulation, ...) can be
+     * swapped in behind the same interface.
+     */
+    class SocketNetwork : public ClientNetwork
+    {
+        public:
+
+        SocketNetwork() {};
+
+        ~SocketNetwork() {};
+
+        bool setup() override
+        {
+            return net_.setup();
+        }
+
+        bool connect(const char* ip_addr, const int port) override
+        {
+            return net_.connect(ip_addr, port);
+        }
+
+        bool disconnect() override
+        {
+            return net_.disconnect();
+        }
+
+        bool isConnected() override
+        {
+            return net_.isConnected();
+        }
+
+        bool shutdown() override
+        {
+            return net_.shutdown();
+        }
+
+        bool readData() override
+        {
+            return net_.readData();
+        }
+
+        bool getData(AlliedState &recv_data) override
+        {
+            return net_.getData(recv_data);
+        }
+
+        bool setData(const AlliedPlan &send_data) override
+        {
+            return net_.setData(send_data);
+        }
+
+        bool writeData() override
+        {
+            return net_.writeData();
+        }
+
+        private:
+
+        RobotNetwork net_;
+    };
+}
+
+#endif
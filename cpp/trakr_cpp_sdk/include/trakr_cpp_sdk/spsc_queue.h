@@ -0,0 +1,131 @@
+/**
+ * @file spsc_queue.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Bounded single-producer/single-consumer queue
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+
+/**
+ * @brief Lock-free ring shared between exactly one producer thread
+ * and exactly one consumer thread. All storage is allocated in the
+ * constructor, so push/pop never allocate or enter the kernel.
+ */
+template <typename T>
+class SpscQueue
+{
+    public:
+
+    /// @brief capacity is rounded up to the next power of two
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_.resize(size);
+    }
+
+    /// @brief reserve the next free slot (producer only)
+    /// @return nullptr if the queue is full
+    T* beginPush()
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if(head - tail_cache_ > mask_)
+        {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if(head - tail_cache_ > mask_)
+            {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    /// @brief publish the slot returned by beginPush() (producer only)
+    void endPush()
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// @brief copy an element in (producer only)
+    /// @return false if the queue is full
+    bool push(const T &item)
+    {
+        T* slot = beginPush();
+        if(slot == nullptr)
+        {
+            return false;
+        }
+        *slot = item;
+        endPush();
+        return true;
+    }
+
+    /// @brief peek at the oldest element (consumer only)
+    /// @return nullptr if the queue is empty
+    T* front()
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if(tail == head_cache_)
+        {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if(tail == head_cache_)
+            {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+
+    /// @brief release the element returned by front() (consumer only)
+    void pop()
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// @brief copy out the oldest element (consumer only)
+    /// @return false if the queue is empty
+    bool pop(T &item)
+    {
+        T* slot = front();
+        if(slot == nullptr)
+        {
+            return false;
+        }
+        item = *slot;
+        pop();
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    private:
+
+    std::vector<T> slots_;
+
+    size_t mask_ = 0;
+
+    /// @brief producer and consumer indices kept on separate cache lines
+    alignas(64) std::atomic<size_t> head_ {0};
+    size_t tail_cache_ = 0;
+
+    alignas(64) std::atomic<size_t> tail_ {0};
+    size_t head_cache_ = 0;
+};
+
+#endif
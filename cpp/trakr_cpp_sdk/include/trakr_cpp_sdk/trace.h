@@ -0,0 +1,118 @@
+/**
+ * @file trace.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Scoped trace markers exported as Chrome/Perfetto trace events
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "clock_source.h"
+
+/**
+ * @brief Lightweight tracing of the control loop phases.
+ *
+ * Every thread records completed scopes into its own fixed-size ring
+ * (single writer, no locks, no allocation after the first event of the
+ * thread). When tracing is disabled, a scope costs one relaxed load.
+ *
+ * The rings are flushed on demand to a Chrome trace-event JSON file,
+ * which opens in chrome://tracing and in ui.perfetto.dev.
+ *
+ *  TRAKR_TRACE_SCOPE("inference");
+ */
+namespace Trace
+{
+    /// @brief one completed scope; name must be a string literal
+    struct Event
+    {
+        const char* name = nullptr;
+        uint64_t begin = 0;
+        uint64_t end = 0;
+    };
+
+    /// @brief monotonic time (ns), SystemClock::monotonic()
+    inline uint64_t now()
+    {
+        return SystemClock::monotonic();
+    }
+
+    extern std::atomic<bool> enabled_;
+
+    /// @brief start/stop recording
+    void enable(bool on = true);
+
+    inline bool isEnabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief events kept per thread (oldest overwritten); applies to
+    /// threads recording their first event afterwards
+    void setBufferSize(size_t events);
+
+    /// @brief name shown for the calling thread in the timeline
+    void setThreadName(const std::string &name);
+
+    /// @brief record a completed scope for the calling thread
+    void record(const char* name, uint64_t begin, uint64_t end);
+
+    /// @brief write every recorded event as Chrome trace-event JSON
+    /// @return
+    bool writeChrome(const std::string &path);
+
+    /// @brief drop every recorded event
+    void clear();
+
+    /**
+     * @brief Records the lifetime of the enclosing scope
+     *
+     */
+    class Scope
+    {
+        public:
+
+        explicit Scope(const char* name)
+            : name_(isEnabled() ? name : nullptr), begin_(name_ ? now() : 0)
+        {
+        }
+
+        ~Scope()
+        {
+            if(name_ != nullptr)
+            {
+                record(name_, begin_, now());
+            }
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+        private:
+
+        const char* name_;
+
+        uint64_t begin_;
+    };
+};
+
+#define TRAKR_TRACE_CONCAT_(a, b) a##b
+#define TRAKR_TRACE_NAME_(line) TRAKR_TRACE_CONCAT_(trakr_trace_scope_, line)
+
+#ifdef TRAKR_NO_TRACE
+#define TRAKR_TRACE_SCOPE(name)
+#else
+#define TRAKR_TRACE_SCOPE(name) Trace::Scope TRAKR_TRACE_NAME_(__LINE__)(name)
+#endif
+
+#endif
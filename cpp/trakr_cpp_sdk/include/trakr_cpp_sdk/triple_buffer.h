@@ -0,0 +1,96 @@
+/**
+ * @file triple_buffer.h
+ * @author Addverb Technologies (humanoid@addverb.com)
+ * @brief Latest-value slot shared between one writer and one reader
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef TRIPLE_BUFFER_H_
+#define TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Wait-free handoff of the latest value from exactly one writer
+ * thread to exactly one reader thread. The writer never waits for the
+ * reader and the reader always sees a complete value; intermediate
+ * values the reader did not pick up are overwritten.
+ */
+template <typename T>
+class TripleBuffer
+{
+    public:
+
+    TripleBuffer()
+    {
+    }
+
+    /// @brief slot to fill before publish() (writer only)
+    T& back()
+    {
+        return slots_[back_];
+    }
+
+    /// @brief make back() the latest value (writer only)
+    void publish()
+    {
+        back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /// @brief copy a value in and publish it (writer only)
+    void write(const T &value)
+    {
+        back() = value;
+        publish();
+    }
+
+    /// @brief take the latest published value, if any (reader only)
+    /// @return true if front() changed
+    bool update()
+    {
+        if((middle_.load(std::memory_order_relaxed) & FRESH) == 0)
+        {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /// @brief latest value taken by update() (reader only)
+    const T& front() const
+    {
+        return slots_[front_];
+    }
+
+    /// @brief update(), then copy the value out (reader only)
+    /// @return true if the value is newer than the previous read
+    bool read(T &value)
+    {
+        const bool fresh = update();
+        value = slots_[front_];
+        return fresh;
+    }
+
+    private:
+
+    static constexpr uint8_t INDEX = 3;
+
+    static constexpr uint8_t FRESH = 4;
+
+    T slots_[3] {};
+
+    /// @brief index of the shared slot, with FRESH set once published
+    alignas(64) std::atomic<uint8_t> middle_ {1};
+
+    /// @brief slot owned by the writer
+    alignas(64) uint8_t back_ = 0;
+
+    /// @brief slot owned by the reader
+    alignas(64) uint8_t front_ = 2;
+};
+
+#endif
@@ -1,35 +1,109 @@
+#include <cstddef>
+#include <cstring>
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include <pybind11/eigen.h>
 #include "trakr_sdk.h"
+#include "robot_runner.h"
+#include "shared_command.h"
 
 namespace py = pybind11;
 
+/**
+ * @brief Packet array bound as a writable numpy view of the packet memory (no copy);
+ * the view keeps the packet alive. Assigning an array-like copies it in place.
+ *
+ */
+template <typename Class, size_t N>
+void defArray_(py::class_<Class> &cls, const char* name, std::array<float, N> Class::*member)
+{
+    cls.def_property(name,
+        [member](py::object self)
+        {
+            Class &object = self.cast<Class&>();
+            return py::array_t<float>({static_cast<py::ssize_t>(N)},
+                                      {static_cast<py::ssize_t>(sizeof(float))},
+                                      (object.*member).data(), self);
+        },
+        [member, name](Class &object, py::array_t<float, py::array::c_style | py::array::forcecast> values)
+        {
+            if(values.size() != static_cast<py::ssize_t>(N))
+            {
+                throw py::value_error(std::string(name) + " expects " + std::to_string(N) + " values");
+            }
+            std::memcpy((object.*member).data(), values.data(), N * sizeof(float));
+        });
+}
+
+/**
+ * @brief Eigen vector bound as a writable numpy view (float64, no copy) of the
+ * member; assigning an array-like copies it in place.
+ *
+ */
+template <typename Class, typename Vector>
+void defVector_(py::class_<Class> &cls, const char* name, Vector Class::*member)
+{
+    cls.def_property(name,
+        py::cpp_function([member](Class &object) -> Vector& { return object.*member; },
+                         py::return_value_policy::reference_internal),
+        [member](Class &object, const Vector &value) { object.*member = value; });
+}
+
+/**
+ * @brief Enum member bound as its integer value
+ *
+ */
+template <typename Class, typename Enum>
+void defEnum_(py::class_<Class> &cls, const char* name, Enum Class::*member)
+{
+    cls.def_property(name,
+        [member](const Class &object) { return static_cast<int>(object.*member); },
+        [member](Class &object, int value) { object.*member = static_cast<Enum>(value); });
+}
+
+/// @brief pos, vel, tor, kp and kd follow each other, so that they can be viewed as one array
+static_assert(offsetof(SocketDataTypes::JointState, kd) - offsetof(SocketDataTypes::JointState, pos)
+              == 4 * sizeof(std::array<float, NDOF>), "JointState arrays are not contiguous");
+
 PYBIND11_MODULE(trakr_python_sdk, m)
 {
     m.doc() = "Trakr Socket SDK";
 
-    py::class_<SocketDataTypes::JointState>(m, "JointState")
+    // arrays of the continuous data are numpy views into the packet (see defArray_)
+    py::class_<SocketDataTypes::JointState> joint_state(m, "JointState");
+    joint_state
         .def(py::init())
-        .def_readwrite("pos", &SocketDataTypes::JointState::pos)
-        .def_readwrite("vel", &SocketDataTypes::JointState::vel)
-        .def_readwrite("tor", &SocketDataTypes::JointState::tor)
-        .def_readwrite("kp", &SocketDataTypes::JointState::kp)
-        .def_readwrite("kd", &SocketDataTypes::JointState::kd)
-        .def_readwrite("timestamp", &SocketDataTypes::JointState::timestamp);
+        .def_readwrite("timestamp", &SocketDataTypes::JointState::timestamp)
+        .def_property_readonly("data", [](py::object self)
+        {
+            SocketDataTypes::JointState &joint = self.cast<SocketDataTypes::JointState&>();
+            return py::array_t<float>({static_cast<py::ssize_t>(5), static_cast<py::ssize_t>(NDOF)},
+                                      {static_cast<py::ssize_t>(sizeof(std::array<float, NDOF>)),
+                                       static_cast<py::ssize_t>(sizeof(float))},
+                                      joint.pos.data(), self);
+        }, "(5, NDOF) view of pos, vel, tor, kp and kd");
+    defArray_(joint_state, "pos", &SocketDataTypes::JointState::pos);
+    defArray_(joint_state, "vel", &SocketDataTypes::JointState::vel);
+    defArray_(joint_state, "tor", &SocketDataTypes::JointState::tor);
+    defArray_(joint_state, "kp", &SocketDataTypes::JointState::kp);
+    defArray_(joint_state, "kd", &SocketDataTypes::JointState::kd);
 
-    py::class_<SocketDataTypes::TorsoState>(m, "TorsoState")
+    py::class_<SocketDataTypes::TorsoState> torso_state(m, "TorsoState");
+    torso_state
         .def(py::init())
-        .def_readwrite("pos", &SocketDataTypes::TorsoState::pos)
-        .def_readwrite("vel", &SocketDataTypes::TorsoState::vel)
         .def_readwrite("timestamp", &SocketDataTypes::TorsoState::timestamp);
+    defArray_(torso_state, "pos", &SocketDataTypes::TorsoState::pos);
+    defArray_(torso_state, "vel", &SocketDataTypes::TorsoState::vel);
 
-    py::class_<SocketDataTypes::IMUState>(m, "IMUState")
+    py::class_<SocketDataTypes::IMUState> imu_state(m, "IMUState");
+    imu_state
         .def(py::init())
-        .def_readwrite("acc", &SocketDataTypes::IMUState::acc)
-        .def_readwrite("gyro", &SocketDataTypes::IMUState::gyro)
-        .def_readwrite("mag", &SocketDataTypes::IMUState::mag)
-        .def_readwrite("euler", &SocketDataTypes::IMUState::euler)
         .def_readwrite("timestamp", &SocketDataTypes::IMUState::timestamp);
+    defArray_(imu_state, "acc", &SocketDataTypes::IMUState::acc);
+    defArray_(imu_state, "gyro", &SocketDataTypes::IMUState::gyro);
+    defArray_(imu_state, "mag", &SocketDataTypes::IMUState::mag);
+    defArray_(imu_state, "euler", &SocketDataTypes::IMUState::euler);
 
     py::class_<SocketDataTypes::BatteryState>(m, "BatteryState")
         .def(py::init());
@@ -71,18 +145,19 @@ PYBIND11_MODULE(trakr_python_sdk, m)
         .def(py::init())
         .def_readwrite("enabled", &SocketDataTypes::SafetyBaseConfig::enabled);
 
-    py::class_<SocketDataTypes::LLSafetyConfig>(m, "LLSafetyConfig")
+    py::class_<SocketDataTypes::LLSafetyConfig> llsafety_config(m, "LLSafetyConfig");
+    llsafety_config
         .def(py::init())
         .def_readwrite("enabled", &SocketDataTypes::LLSafetyConfig::enabled)
         .def_readwrite("jpos", &SocketDataTypes::LLSafetyConfig::jpos)
         .def_readwrite("jvel", &SocketDataTypes::LLSafetyConfig::jvel)
         .def_readwrite("jtor", &SocketDataTypes::LLSafetyConfig::jtor)
-        .def_readwrite("dtor", &SocketDataTypes::LLSafetyConfig::dtor)
-        .def_readwrite("lim_jpos_min", &SocketDataTypes::LLSafetyConfig::lim_jpos_min)
-        .def_readwrite("lim_jpos_max", &SocketDataTypes::LLSafetyConfig::lim_jpos_max)
-        .def_readwrite("lim_jvel", &SocketDataTypes::LLSafetyConfig::lim_jvel)
-        .def_readwrite("lim_jtor", &SocketDataTypes::LLSafetyConfig::lim_jtor)
-        .def_readwrite("lim_dtor", &SocketDataTypes::LLSafetyConfig::lim_dtor);
+        .def_readwrite("dtor", &SocketDataTypes::LLSafetyConfig::dtor);
+    defArray_(llsafety_config, "lim_jpos_min", &SocketDataTypes::LLSafetyConfig::lim_jpos_min);
+    defArray_(llsafety_config, "lim_jpos_max", &SocketDataTypes::LLSafetyConfig::lim_jpos_max);
+    defArray_(llsafety_config, "lim_jvel", &SocketDataTypes::LLSafetyConfig::lim_jvel);
+    defArray_(llsafety_config, "lim_jtor", &SocketDataTypes::LLSafetyConfig::lim_jtor);
+    defArray_(llsafety_config, "lim_dtor", &SocketDataTypes::LLSafetyConfig::lim_dtor);
 
     py::class_<SocketDataTypes::LLHeartbeatConfig>(m, "LLHeartbeatConfig")
         .def(py::init())
@@ -144,4 +219,225 @@ PYBIND11_MODULE(trakr_python_sdk, m)
         .def("getData", &ClientNetworkConfig::RobotNetwork::getData)
         .def("setData", &ClientNetworkConfig::RobotNetwork::setData)
         .def("writeData", &ClientNetworkConfig::RobotNetwork::writeData);
+
+    // Data types of the C++ Robot, for RobotRunner
+    py::module_ allied = m.def_submodule("allied", "AlliedDataTypes of trakr_cpp_sdk");
+
+    py::class_<AlliedDataTypes::JointState> allied_joint(allied, "JointState");
+    allied_joint
+        .def(py::init())
+        .def_readwrite("timestamp", &AlliedDataTypes::JointState::timestamp);
+    defVector_(allied_joint, "pos", &AlliedDataTypes::JointState::pos);
+    defVector_(allied_joint, "vel", &AlliedDataTypes::JointState::vel);
+    defVector_(allied_joint, "tor", &AlliedDataTypes::JointState::tor);
+    defVector_(allied_joint, "kp", &AlliedDataTypes::JointState::kp);
+    defVector_(allied_joint, "kd", &AlliedDataTypes::JointState::kd);
+
+    py::class_<AlliedDataTypes::TorsoState> allied_torso(allied, "TorsoState");
+    allied_torso
+        .def(py::init())
+        .def_readwrite("timestamp", &AlliedDataTypes::TorsoState::timestamp);
+    defVector_(allied_torso, "pos", &AlliedDataTypes::TorsoState::pos);
+    defVector_(allied_torso, "vel", &AlliedDataTypes::TorsoState::vel);
+
+    py::class_<AlliedDataTypes::IMUState> allied_imu(allied, "IMUState");
+    allied_imu
+        .def(py::init())
+        .def_readwrite("timestamp", &AlliedDataTypes::IMUState::timestamp);
+    defVector_(allied_imu, "acc", &AlliedDataTypes::IMUState::acc);
+    defVector_(allied_imu, "gyro", &AlliedDataTypes::IMUState::gyro);
+    defVector_(allied_imu, "mag", &AlliedDataTypes::IMUState::mag);
+    defVector_(allied_imu, "euler", &AlliedDataTypes::IMUState::euler);
+
+    py::class_<AlliedDataTypes::Plan>(allied, "Plan")
+        .def(py::init())
+        .def_readwrite("torso", &AlliedDataTypes::Plan::torso)
+        .def_readwrite("joint", &AlliedDataTypes::Plan::joint);
+
+    py::class_<AlliedDataTypes::State>(allied, "State")
+        .def(py::init())
+        .def_readwrite("torso", &AlliedDataTypes::State::torso)
+        .def_readwrite("joint", &AlliedDataTypes::State::joint)
+        .def_readwrite("imu", &AlliedDataTypes::State::imu);
+
+    // CONFIG_SET of the C++ Robot; enums are their integer values
+    py::module_ quad = m.def_submodule("quad", "QuadDataTypes of trakr_cpp_sdk");
+
+    py::class_<QuadDataTypes::ROBOT_CONFIG>(quad, "RobotConfig")
+        .def(py::init())
+        .def_readwrite("shutdown", &QuadDataTypes::ROBOT_CONFIG::shutdown)
+        .def_readwrite("exit", &QuadDataTypes::ROBOT_CONFIG::exit)
+        .def_readwrite("killed", &QuadDataTypes::ROBOT_CONFIG::killed);
+
+    py::class_<MotionDataTypes::GestureConfig> gesture_config(quad, "GestureConfig");
+    gesture_config
+        .def(py::init())
+        .def_readwrite("seq", &MotionDataTypes::GestureConfig::seq);
+    defEnum_(gesture_config, "type", &MotionDataTypes::GestureConfig::type);
+
+    py::class_<MotionDataTypes::MotionConfig> motion_strategy(quad, "MotionStrategy");
+    motion_strategy
+        .def(py::init());
+    defEnum_(motion_strategy, "type", &MotionDataTypes::MotionConfig::type);
+    defEnum_(motion_strategy, "seq", &MotionDataTypes::MotionConfig::seq);
+
+    py::class_<MotionDataTypes::CONFIG_SET> motion_set(quad, "MotionConfig");
+    motion_set
+        .def(py::init())
+        .def_readwrite("sequence", &MotionDataTypes::CONFIG_SET::sequence)
+        .def_readwrite("strategy", &MotionDataTypes::CONFIG_SET::strategy);
+    defEnum_(motion_set, "planner", &MotionDataTypes::CONFIG_SET::planner);
+
+    py::class_<SafetyDataTypes::LLSafetyConfig> quad_llsafety(quad, "LLSafetyConfig");
+    quad_llsafety
+        .def(py::init())
+        .def_readwrite("enabled", &SafetyDataTypes::LLSafetyConfig::enabled)
+        .def_readwrite("jpos", &SafetyDataTypes::LLSafetyConfig::jpos)
+        .def_readwrite("jvel", &SafetyDataTypes::LLSafetyConfig::jvel)
+        .def_readwrite("jtor", &SafetyDataTypes::LLSafetyConfig::jtor)
+        .def_readwrite("dtor", &SafetyDataTypes::LLSafetyConfig::dtor)
+        .def_readwrite("check_nan", &SafetyDataTypes::LLSafetyConfig::check_nan);
+    defVector_(quad_llsafety, "lim_jpos_min", &SafetyDataTypes::LLSafetyConfig::lim_jpos_min);
+    defVector_(quad_llsafety, "lim_jpos_max", &SafetyDataTypes::LLSafetyConfig::lim_jpos_max);
+    defVector_(quad_llsafety, "lim_jvel", &SafetyDataTypes::LLSafetyConfig::lim_jvel);
+    defVector_(quad_llsafety, "lim_jtor", &SafetyDataTypes::LLSafetyConfig::lim_jtor);
+    defVector_(quad_llsafety, "lim_dtor", &SafetyDataTypes::LLSafetyConfig::lim_dtor);
+
+    py::class_<SafetyDataTypes::LLHeartbeatConfig>(quad, "LLHeartbeatConfig")
+        .def(py::init())
+        .def_readwrite("enabled", &SafetyDataTypes::LLHeartbeatConfig::enabled)
+        .def_readwrite("init_disable_time", &SafetyDataTypes::LLHeartbeatConfig::init_disable_time)
+        .def_readwrite("enable_CAN", &SafetyDataTypes::LLHeartbeatConfig::enable_CAN)
+        .def_readwrite("CAN_timeout", &SafetyDataTypes::LLHeartbeatConfig::CAN_timeout)
+        .def_readwrite("observe_jpos", &SafetyDataTypes::LLHeartbeatConfig::observe_jpos)
+        .def_readwrite("observe_jvel", &SafetyDataTypes::LLHeartbeatConfig::observe_jvel)
+        .def_readwrite("observe_jtor", &SafetyDataTypes::LLHeartbeatConfig::observe_jtor)
+        .def_readwrite("enable_IMU", &SafetyDataTypes::LLHeartbeatConfig::enable_IMU)
+        .def_readwrite("IMU_timeout", &SafetyDataTypes::LLHeartbeatConfig::IMU_timeout)
+        .def_readwrite("observe_accel", &SafetyDataTypes::LLHeartbeatConfig::observe_accel)
+        .def_readwrite("observe_gyro", &SafetyDataTypes::LLHeartbeatConfig::observe_gyro);
+
+    py::class_<SafetyDataTypes::TorsoSafetyConfig>(quad, "TorsoSafetyConfig")
+        .def(py::init())
+        .def_readwrite("enabled", &SafetyDataTypes::TorsoSafetyConfig::enabled)
+        .def_readwrite("observe_roll", &SafetyDataTypes::TorsoSafetyConfig::observe_roll)
+        .def_readwrite("roll_limit", &SafetyDataTypes::TorsoSafetyConfig::roll_limit)
+        .def_readwrite("observe_pitch", &SafetyDataTypes::TorsoSafetyConfig::observe_pitch)
+        .def_readwrite("pitch_limit", &SafetyDataTypes::TorsoSafetyConfig::pitch_limit)
+        .def_readwrite("observe_gyro", &SafetyDataTypes::TorsoSafetyConfig::observe_gyro)
+        .def_readwrite("gyro_limit", &SafetyDataTypes::TorsoSafetyConfig::gyro_limit);
+
+    py::class_<SafetyDataTypes::CONFIG_SET>(quad, "SafetyConfig")
+        .def(py::init())
+        .def_readwrite("llsafety", &SafetyDataTypes::CONFIG_SET::llsafety)
+        .def_readwrite("llheartbeat", &SafetyDataTypes::CONFIG_SET::llheartbeat)
+        .def_readwrite("torso", &SafetyDataTypes::CONFIG_SET::torso);
+
+    py::class_<QuadDataTypes::CONFIG_SET>(quad, "ConfigSet")
+        .def(py::init())
+        .def_readwrite("master", &QuadDataTypes::CONFIG_SET::master)
+        .def_readwrite("motion", &QuadDataTypes::CONFIG_SET::motion)
+        .def_readwrite("safety", &QuadDataTypes::CONFIG_SET::safety);
+
+    // C++ Robot exchanged with from its own thread; the calls that block
+    // (bring-up, joining the thread) release the GIL, and the thread never
+    // takes it, so Python pauses do not delay the exchange
+    m.attr("HIGH_LEVEL") = HIGH_LEVEL;
+    m.attr("LOW_LEVEL") = LOW_LEVEL;
+
+    // observation layout, as (name, offset, size) in float32 values
+    m.attr("OBSERVATION_SIZE") = Observation::SIZE;
+    py::list observation_fields;
+    for(const Observation::Field &field : Observation::FIELDS)
+    {
+        observation_fields.append(py::make_tuple(field.name, field.offset, field.size));
+    }
+    m.attr("OBSERVATION_FIELDS") = observation_fields;
+
+    py::class_<RobotRunner>(m, "RobotRunner")
+        .def(py::init<const char*, const int, int, double>(),
+             py::arg("ip"), py::arg("port"), py::arg("mode") = HIGH_LEVEL, py::arg("rate") = 1000.0)
+        .def("start", &RobotRunner::start, py::call_guard<py::gil_scoped_release>())
+        .def("stop", &RobotRunner::stop, py::call_guard<py::gil_scoped_release>())
+        .def("isAlive", &RobotRunner::isAlive)
+        .def("setData", &RobotRunner::setData)
+        .def("getData", &RobotRunner::getData)
+        .def("setConfig", &RobotRunner::setConfig)
+        .def("getConfig", &RobotRunner::getConfig)
+        .def("getConfigStatus", &RobotRunner::getConfigStatus)
+        .def("configTicket", &RobotRunner::configTicket)
+        .def("getObservation", [](RobotRunner &runner, py::array_t<float, py::array::c_style> out)
+        {
+            if(out.size() != static_cast<py::ssize_t>(Observation::SIZE))
+            {
+                throw py::value_error("getObservation expects a float32 array of OBSERVATION_SIZE values");
+            }
+            return runner.getObservation(out.mutable_data());
+        }, py::arg("out").noconvert(), "fill out (float32, OBSERVATION_SIZE) with the latest state; true if not read before")
+        .def("setHistory", &RobotRunner::setHistory)
+        .def("getHistory", [](const RobotRunner &runner, py::array_t<float, py::array::c_style> rows, py::object stamps)
+        {
+            if((rows.ndim() != 2) || (rows.shape(1) != static_cast<py::ssize_t>(Observation::SIZE)))
+            {
+                throw py::value_error("getHistory expects a float32 array of shape (N, OBSERVATION_SIZE)");
+            }
+            uint64_t* stamp_data = nullptr;
+            if(!stamps.is_none())
+            {
+                if(!py::isinstance<py::array_t<uint64_t, py::array::c_style>>(stamps))
+                {
+                    throw py::type_error("getHistory expects stamps as a uint64 array");
+                }
+                py::array_t<uint64_t, py::array::c_style> stamp_array = stamps.cast<py::array_t<uint64_t, py::array::c_style>>();
+                if(stamp_array.size() != rows.shape(0))
+                {
+                    throw py::value_error("getHistory expects N uint64 stamps");
+                }
+                stamp_data = stamp_array.mutable_data();
+            }
+            return runner.getHistory(rows.mutable_data(), stamp_data, rows.shape(0));
+        }, py::arg("rows").noconvert(), py::arg("stamps") = py::none(),
+        "copy the last N observations into rows, oldest first; returns the number copied")
+        .def("publishState", &RobotRunner::publishState,
+             "publish every state received into /dev/shm/<name> (before start())")
+        .def("openNotifyFd", &RobotRunner::openNotifyFd,
+             "eventfd signalled after every cycle, for event loops (before start())")
+        .def("cycles", &RobotRunner::cycles)
+        .def("overruns", &RobotRunner::overruns);
+
+    // reader of the states published in shared memory by another process
+    py::class_<SharedState::Reader>(m, "SharedStateReader")
+        .def(py::init<const std::string&>(), py::arg("name") = "trakr_state")
+        .def("open", &SharedState::Reader::open)
+        .def("read", [](const SharedState::Reader &reader, py::array_t<uint8_t, py::array::c_style> packet)
+        {
+            if(packet.size() != static_cast<py::ssize_t>(reader.packetSize()))
+            {
+                throw py::value_error("read expects a uint8 array of packetSize() bytes");
+            }
+            uint64_t stamp = 0;
+            const uint64_t count = reader.read(packet.mutable_data(), &stamp);
+            return py::make_tuple(count, stamp);
+        }, py::arg("packet").noconvert(), "copy the latest packet; returns (states published, receive stamp)")
+        .def("count", &SharedState::Reader::count)
+        .def("packetSize", &SharedState::Reader::packetSize)
+        .def("fields", [](const SharedState::Reader &reader)
+        {
+            py::list fields;
+            for(const PacketFields::Field &field : reader.fields())
+            {
+                fields.append(py::make_tuple(field.name, static_cast<uint32_t>(field.type), field.offset));
+            }
+            return fields;
+        }, "channels of the packet, as (name, type, byte offset)");
+
+    py::class_<SharedCommand::Controller>(m, "SharedCommandController")
+        .def(py::init<const std::string&>(), py::arg("name") = "trakr_command")
+        .def("open", &SharedCommand::Controller::open, "become the controller of a running broker")
+        .def("close", &SharedCommand::Controller::close)
+        .def("isAlive", &SharedCommand::Controller::isAlive)
+        .def("setData", &SharedCommand::Controller::setData)
+        .def("setConfig", &SharedCommand::Controller::setConfig, "configuration to be sent once; returns its ticket")
+        .def("configStatus", &SharedCommand::Controller::configStatus,
+             "answer to the configuration of a ticket : 0 pending, 1 sent, 2 accepted, 3 rejected");
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "clock_source.h"
+
+#include <errno.h>
+#include <time.h>
+
+uint64_t SystemClock::now()
+{
+    return monotonic();
+}
+
+/**
+ * @brief Absolute sleep, resumed if interrupted by a signal
+ *
+ */
+void SystemClock::sleepUntil(uint64_t deadline)
+{
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000ull;
+    ts.tv_nsec = deadline % 1000000000ull;
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+    {
+    }
+}
+
+SystemClock& SystemClock::instance()
+{
+    static SystemClock clock;
+    return clock;
+}
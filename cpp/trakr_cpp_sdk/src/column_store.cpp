@@ -0,0 +1,321 @@
+#include "column_store.h"
+#include "flight_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ColumnStore
+{
+
+/// @brief where a column takes its values from
+struct Source
+{
+    ColumnDesc desc;
+
+    /// @brief 0 : stamp, 1 : plan stamp, 2 : AlliedState, 3 : AlliedPlan, 4 : session
+    int packet;
+    size_t offset;
+};
+
+static size_t aligned_(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+static void addSource_(std::vector<Source> &sources, const std::string &name, PacketFields::FieldType type, int packet, size_t offset)
+{
+    Source src;
+    std::strncpy(src.desc.name, name.c_str(), NAME_SIZE - 1);
+    src.desc.type = static_cast<uint32_t>(type);
+    src.desc.elem_size = static_cast<uint32_t>(PacketFields::typeSize(type));
+    src.packet = packet;
+    src.offset = offset;
+    sources.push_back(src);
+}
+
+static std::string columnName_(const std::string &prefix, const std::string &field)
+{
+    // "config.*" exists in both packets
+    if(field.compare(0, 7, "config.") == 0)
+    {
+        return prefix + field;
+    }
+    return field;
+}
+
+/**
+ * @brief Two passes over the log : count the rows, then scatter every
+ * record straight into the mapped output, so memory stays bounded
+ * whatever the session length.
+ *
+ */
+bool exportLog(const std::string &log_path, const std::string &out_path)
+{
+    FlightLog::Reader reader;
+    FlightLog::Entry entry;
+
+    if(!reader.open(log_path))
+    {
+        std::cout << "[COLUMNS] Unable to open log " << log_path << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    header.wall_ns = reader.header().wall_ns;
+    header.mono_ns = reader.header().mono_ns;
+
+    while(reader.next(entry))
+    {
+        if(entry.type == FlightLog::RecordType::eState)
+        {
+            header.rows++;
+        }
+    }
+
+    if(header.rows == 0)
+    {
+        std::cout << "[COLUMNS] No state recorded in " << log_path << std::endl;
+        return false;
+    }
+
+    // column layout
+    std::vector<Source> sources;
+    addSource_(sources, "stamp", PacketFields::FieldType::eUInt64, 0, 0);
+    addSource_(sources, "plan_stamp", PacketFields::FieldType::eUInt64, 1, 0);
+    addSource_(sources, "session", PacketFields::FieldType::eInt32, 4, 0);
+    for(const PacketFields::Field &f : PacketFields::stateFields())
+    {
+        addSource_(sources, columnName_("state.", f.name), f.type, 2, f.offset);
+    }
+    for(const PacketFields::Field &f : PacketFields::planFields())
+    {
+        addSource_(sources, columnName_("plan.", f.name), f.type, 3, f.offset);
+    }
+
+    header.columns = static_cast<uint32_t>(sources.size());
+
+    size_t size = aligned_(sizeof(FileHeader) + sources.size() * sizeof(ColumnDesc));
+    for(Source &src : sources)
+    {
+        src.desc.offset = size;
+        size += aligned_(header.rows * src.desc.elem_size);
+    }
+
+    int fd = ::open(out_path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        std::cout << "[COLUMNS] Unable to create " << out_path << std::endl;
+        return false;
+    }
+
+    if(ftruncate(fd, size) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+    {
+        return false;
+    }
+    unsigned char* out = static_cast<unsigned char*>(map);
+
+    std::memcpy(out, &header, sizeof(header));
+    for(size_t i = 0; i < sources.size(); i++)
+    {
+        std::memcpy(out + sizeof(header) + i * sizeof(ColumnDesc), &sources[i].desc, sizeof(ColumnDesc));
+    }
+
+    // scatter the rows
+    reader.open(log_path);
+
+    size_t row = 0;
+    bool has_row = false;
+    bool has_plan = false;
+
+    // the stamps (steady clock) restart with the robot : a new session
+    int32_t session = 0;
+    uint64_t last_stamp = 0;
+
+    while(reader.next(entry) && (row < header.rows))
+    {
+        const unsigned char* packet = nullptr;
+        int kind = 0;
+
+        if(entry.type == FlightLog::RecordType::eState)
+        {
+            if(has_row)
+            {
+                row++;
+            }
+            if(row >= header.rows)
+            {
+                break;
+            }
+            if(has_row && (entry.stamp < last_stamp))
+            {
+                session++;
+            }
+            last_stamp = entry.stamp;
+            has_row = true;
+            has_plan = false;
+            kind = 2;
+            packet = reinterpret_cast<const unsigned char*>(&entry.state);
+        }
+        else if((entry.type == FlightLog::RecordType::ePlan) && has_row && !has_plan)
+        {
+            has_plan = true;
+            kind = 3;
+            packet = reinterpret_cast<const unsigned char*>(&entry.plan);
+        }
+        else
+        {
+            continue;
+        }
+
+        for(const Source &src : sources)
+        {
+            unsigned char* dst = out + src.desc.offset + row * src.desc.elem_size;
+
+            if(src.packet == kind)
+            {
+                std::memcpy(dst, packet + src.offset, src.desc.elem_size);
+            }
+            else if((src.packet == 0) && (kind == 2))
+            {
+                std::memcpy(dst, &entry.stamp, sizeof(uint64_t));
+            }
+            else if((src.packet == 1) && (kind == 3))
+            {
+                std::memcpy(dst, &entry.stamp, sizeof(uint64_t));
+            }
+            else if((src.packet == 4) && (kind == 2))
+            {
+                std::memcpy(dst, &session, sizeof(int32_t));
+            }
+        }
+    }
+
+    msync(map, size, MS_SYNC);
+    munmap(map, size);
+    return true;
+}
+
+Reader::~Reader()
+{
+    close();
+}
+
+/**
+ * @brief Map the file and load the column directory
+ *
+ */
+bool Reader::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) < sizeof(FileHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    map_ = static_cast<const unsigned char*>(map);
+    size_ = st.st_size;
+
+    std::memcpy(&header_, map_, sizeof(header_));
+    if((std::memcmp(header_.magic, FileHeader().magic, sizeof(header_.magic)) != 0)
+        || (header_.version != FILE_VERSION)
+        || (sizeof(FileHeader) + header_.columns * sizeof(ColumnDesc) > size_))
+    {
+        std::cout << "[COLUMNS] Not a column file " << path << std::endl;
+        close();
+        return false;
+    }
+
+    columns_.resize(header_.columns);
+    for(size_t i = 0; i < columns_.size(); i++)
+    {
+        std::memcpy(&columns_[i], map_ + sizeof(FileHeader) + i * sizeof(ColumnDesc), sizeof(ColumnDesc));
+        if(columns_[i].offset + header_.rows * columns_[i].elem_size > size_)
+        {
+            std::cout << "[COLUMNS] Truncated column file " << path << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Reader::close()
+{
+    if(map_ != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(map_), size_);
+        map_ = nullptr;
+    }
+    size_ = 0;
+    header_ = FileHeader();
+    columns_.clear();
+}
+
+/**
+ * @brief Binary search over the rows of the session only, where "stamp" is
+ * sorted; files without a "session" column are a single session
+ *
+ */
+size_t Reader::lowerBound(uint64_t stamp, int32_t session) const
+{
+    Column<uint64_t> stamps = column<uint64_t>("stamp");
+    if(!stamps.valid())
+    {
+        return 0;
+    }
+
+    const uint64_t* begin = stamps.data;
+    const uint64_t* end = stamps.data + stamps.size;
+
+    Column<int32_t> sessions = column<int32_t>("session");
+    if(sessions.valid())
+    {
+        begin = stamps.data + (std::lower_bound(sessions.data, sessions.data + sessions.size, session) - sessions.data);
+        end = stamps.data + (std::upper_bound(sessions.data, sessions.data + sessions.size, session) - sessions.data);
+    }
+    return std::lower_bound(begin, end, stamp) - stamps.data;
+}
+
+const ColumnDesc* Reader::find_(const std::string &name) const
+{
+    for(const ColumnDesc &desc : columns_)
+    {
+        if(name == desc.name)
+        {
+            return &desc;
+        }
+    }
+    return nullptr;
+}
+
+};
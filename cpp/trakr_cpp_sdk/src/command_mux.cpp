@@ -0,0 +1,97 @@
+#include "command_mux.h"
+#include "flight_recorder.h"
+#include "logger.h"
+
+/**
+ * @brief Insert the slot into the priority order, after the slots of
+ * equal priority
+ *
+ */
+int CommandMux::addSlot(const std::string &name, int priority, double timeout)
+{
+    if(count_ >= MAX_SLOTS)
+    {
+        TRAKR_LOG_ERROR("[MUX] No slot left for %s", name.c_str());
+        return -1;
+    }
+
+    const int index = count_;
+    Slot &slot = slots_[index];
+    slot.name = name;
+    slot.priority = priority;
+    slot.timeout_ns = (timeout > 0.0) ? static_cast<uint64_t>(timeout * 1e9) : 0;
+
+    int position = count_;
+    while((position > 0) && (slots_[order_[position - 1]].priority < priority))
+    {
+        order_[position] = order_[position - 1];
+        position--;
+    }
+    order_[position] = index;
+    count_++;
+    return index;
+}
+
+int CommandMux::slot(const std::string &name) const
+{
+    for(int i = 0; i < count_; i++)
+    {
+        if(slots_[i].name == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void CommandMux::setData(int slot, const AlliedDataTypes::Plan &plan)
+{
+    Command &command = slots_[slot].command.back();
+    command.plan = plan;
+    command.stamp = FlightLog::now();
+    slots_[slot].command.publish();
+}
+
+void CommandMux::release(int slot)
+{
+    slots_[slot].command.back().stamp = 0;
+    slots_[slot].command.publish();
+}
+
+/**
+ * @brief Take the latest command of every slot, then copy the first live
+ * one in priority order
+ *
+ */
+int CommandMux::resolve(AlliedDataTypes::Plan &plan, uint64_t now)
+{
+    int winner = -1;
+    for(int i = 0; i < count_; i++)
+    {
+        Slot &slot = slots_[order_[i]];
+        slot.command.update();
+        if(winner >= 0)
+        {
+            continue;
+        }
+
+        const Command &command = slot.command.front();
+        if((command.stamp != 0) && ((slot.timeout_ns == 0) || (command.stamp + slot.timeout_ns >= now)))
+        {
+            plan = command.plan;
+            winner = order_[i];
+        }
+    }
+
+    if(winner != winner_.load(std::memory_order_relaxed))
+    {
+        winner_.store(winner, std::memory_order_relaxed);
+        switches_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return winner;
+}
+
+int CommandMux::resolve(AlliedDataTypes::Plan &plan)
+{
+    return resolve(plan, FlightLog::now());
+}
@@ -0,0 +1,670 @@
+#include "flight_recorder.h"
+#include "clock_source.h"
+#include "log_codec.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FlightLog
+{
+
+static size_t padded_(size_t size)
+{
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+static bool hasSuffix_(const std::string &name, const std::string &suffix)
+{
+    return (name.size() > suffix.size())
+        && (name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+/**
+ * @brief Split a segment file name <prefix>_<index>.trlog/.trz
+ * @return false if the name is not one of a segment
+ */
+static bool segmentName_(const std::string &name, std::string &prefix, uint32_t &index)
+{
+    const size_t suffix = hasSuffix_(name, ".trlog") ? 6 : (hasSuffix_(name, ".trz") ? 4 : 0);
+    if(suffix == 0)
+    {
+        return false;
+    }
+
+    const std::string stem = name.substr(0, name.size() - suffix);
+    const size_t separator = stem.rfind('_');
+    if((separator == std::string::npos) || (separator == 0))
+    {
+        return false;
+    }
+
+    const std::string digits = stem.substr(separator + 1);
+    if(digits.empty() || (digits.size() > 9) || (digits.find_first_not_of("0123456789") != std::string::npos))
+    {
+        return false;
+    }
+
+    prefix = stem.substr(0, separator);
+    index = static_cast<uint32_t>(std::stoul(digits));
+    return true;
+}
+
+/**
+ * @brief The segments of one prefix in a directory, in index order; an empty
+ * prefix is taken from the first segment (by name)
+ * @param skipped segments of other prefixes
+ */
+static std::vector<std::pair<uint32_t, std::string>> listSegments_(const std::string &directory,
+    std::string &prefix, size_t &skipped)
+{
+    std::vector<std::pair<uint32_t, std::string>> found;
+    skipped = 0;
+
+    DIR* dir = opendir(directory.c_str());
+    if(dir == nullptr)
+    {
+        return found;
+    }
+
+    std::vector<std::string> names;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != nullptr)
+    {
+        names.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for(const auto &name : names)
+    {
+        std::string owner;
+        uint32_t index;
+        if(!segmentName_(name, owner, index))
+        {
+            continue;
+        }
+
+        if(prefix.empty())
+        {
+            prefix = owner;
+        }
+
+        if(owner != prefix)
+        {
+            skipped++;
+            continue;
+        }
+        found.emplace_back(index, directory + "/" + name);
+    }
+
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+static uint64_t wallNow_()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t now()
+{
+    return SystemClock::monotonic();
+}
+
+Recorder::Recorder(const RecorderConfig &config)
+    : config_(config), queue_(config.queue_capacity)
+{
+}
+
+Recorder::~Recorder()
+{
+    stop();
+}
+
+/**
+ * @brief Open the first segment and start the writer thread
+ *
+ */
+bool Recorder::start()
+{
+    if(running_.load())
+    {
+        return true;
+    }
+
+    scanSegments_();
+
+    if(!openSegment_())
+    {
+        TRAKR_LOG_ERROR("[RECORDER] Failed to open segment in %s", config_.directory);
+        return false;
+    }
+
+    running_.store(true);
+    writer_ = std::thread(&Recorder::writerLoop_, this);
+    return true;
+}
+
+/**
+ * @brief Stop the writer thread, write whatever is queued and close
+ *
+ */
+void Recorder::stop()
+{
+    if(!running_.exchange(false))
+    {
+        return;
+    }
+
+    if(writer_.joinable())
+    {
+        writer_.join();
+    }
+
+    drain_();
+    closeSegment_();
+}
+
+bool Recorder::recordState(const ClientNetworkConfig::AlliedState &state, uint64_t stamp)
+{
+    return push_(RecordType::eState, &state, sizeof(state), stamp);
+}
+
+bool Recorder::recordPlan(const ClientNetworkConfig::AlliedPlan &plan, uint64_t stamp)
+{
+    return push_(RecordType::ePlan, &plan, sizeof(plan), stamp);
+}
+
+/**
+ * @brief Copy a packet into the next free slot; no allocation, no syscalls
+ *
+ */
+bool Recorder::push_(RecordType type, const void* data, size_t size, uint64_t stamp)
+{
+    seq_++;
+
+    Slot* slot = queue_.beginPush();
+    if(slot == nullptr)
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slot->header.magic = RECORD_MAGIC;
+    slot->header.type = static_cast<uint16_t>(type);
+    slot->header.size = static_cast<uint16_t>(size);
+    slot->header.seq = seq_;
+    slot->header.stamp = stamp;
+    std::memcpy(slot->payload, data, size);
+
+    queue_.endPush();
+    return true;
+}
+
+/**
+ * @brief Writer thread; drains the queue and flushes periodically
+ *
+ */
+void Recorder::writerLoop_()
+{
+    auto last_sync = std::chrono::steady_clock::now();
+
+    while(running_.load(std::memory_order_relaxed))
+    {
+        if(!drain_())
+        {
+            // nothing queued, the queue absorbs bursts in the meantime
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto t = std::chrono::steady_clock::now();
+        if(std::chrono::duration_cast<std::chrono::milliseconds>(t - last_sync).count() >= config_.fsync_period_ms)
+        {
+            sync_();
+            last_sync = t;
+        }
+    }
+}
+
+/**
+ * @brief Write every queued record into the current segment
+ * @return true if anything was written
+ *
+ */
+bool Recorder::drain_()
+{
+    bool any = false;
+
+    Slot* slot;
+    while((slot = queue_.front()) != nullptr)
+    {
+        if(!append_(*slot))
+        {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        queue_.pop();
+        any = true;
+    }
+
+    return any;
+}
+
+/**
+ * @brief Append one record, rotating to a new segment when full
+ *
+ */
+bool Recorder::append_(const Slot &slot)
+{
+    if(config_.compress)
+    {
+        if(((codec_ == nullptr) || (codec_->bytes() >= config_.segment_size)) && !rotate_())
+        {
+            return false;
+        }
+
+        codec_->write(static_cast<RecordType>(slot.header.type), slot.payload, slot.header.seq, slot.header.stamp);
+        written_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    const size_t size = sizeof(RecordHeader) + padded_(slot.header.size);
+
+    // keep room for the zeroed terminating header
+    if(((map_ == nullptr) || (offset_ + size + sizeof(RecordHeader) > config_.segment_size)) && !rotate_())
+    {
+        return false;
+    }
+
+    // payload first, header last, so a torn write never looks like a record
+    std::memcpy(map_ + offset_ + sizeof(RecordHeader), slot.payload, slot.header.size);
+    std::memcpy(map_ + offset_, &slot.header, sizeof(RecordHeader));
+    offset_ += size;
+
+    written_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Close the current segment and open the next one; after a failure
+ * (disk full, permissions), the open is only retried every
+ * RecorderConfig::retry_period_ms, the records meanwhile counted as failed
+ *
+ */
+bool Recorder::rotate_()
+{
+    const uint64_t t = now();
+    if(t < retry_at_)
+    {
+        return false;
+    }
+
+    closeSegment_();
+    if(!openSegment_())
+    {
+        const int error = errno;
+        retry_at_ = t + static_cast<uint64_t>(config_.retry_period_ms) * 1000000ull;
+        TRAKR_LOG_ERROR("[RECORDER] Failed to open segment in %s (%s)", config_.directory, strerror(error));
+        return false;
+    }
+    retry_at_ = 0;
+    return true;
+}
+
+/**
+ * @brief Adopt the segments of previous sessions (<prefix>_<index>.trlog/.trz
+ * in the directory) : numbering continues after them, so nothing is
+ * overwritten and they are read in order, and they count toward max_segments
+ *
+ */
+void Recorder::scanSegments_()
+{
+    segments_.clear();
+    index_ = 0;
+
+    std::string prefix = config_.prefix;
+    size_t skipped;
+    for(const auto &segment : listSegments_(config_.directory, prefix, skipped))
+    {
+        segments_.push_back(segment.second);
+        index_ = segment.first + 1;
+    }
+}
+
+/**
+ * @brief Create and map a new preallocated segment; drop the oldest if required
+ *
+ */
+bool Recorder::openSegment_()
+{
+    char name[64];
+    snprintf(name, sizeof(name), config_.compress ? "_%06u.trz" : "_%06u.trlog", index_);
+    std::string path = config_.directory + "/" + config_.prefix + name;
+
+    if(config_.compress)
+    {
+        codec_.reset(new LogCodec::Writer());
+        if(!codec_->open(path, config_.block_records, wallNow_(), now()))
+        {
+            codec_.reset();
+            return false;
+        }
+        addSegment_(path);
+        return true;
+    }
+
+    fd_ = ::open(path.c_str(), O_CREAT | O_RDWR | O_EXCL, 0644);
+    if(fd_ < 0)
+    {
+        // taken by another recorder : try the next index
+        if(errno == EEXIST)
+        {
+            index_++;
+            errno = EEXIST;
+        }
+        return false;
+    }
+
+    // reserve the blocks up-front so the writer never extends the file
+    if(posix_fallocate(fd_, 0, config_.segment_size) != 0)
+    {
+        if(ftruncate(fd_, config_.segment_size) != 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+    }
+
+    void* map = mmap(nullptr, config_.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if(map == MAP_FAILED)
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    map_ = static_cast<unsigned char*>(map);
+
+    SegmentHeader header;
+    header.index = index_;
+    header.mono_ns = now();
+    header.wall_ns = wallNow_();
+    std::memcpy(map_, &header, sizeof(header));
+
+    offset_ = padded_(sizeof(SegmentHeader));
+    synced_ = 0;
+
+    addSegment_(path);
+    return true;
+}
+
+/**
+ * @brief Account for a newly opened segment; drop the oldest if required
+ *
+ */
+void Recorder::addSegment_(const std::string &path)
+{
+    index_++;
+
+    segments_.push_back(path);
+    while(static_cast<int>(segments_.size()) > std::max(config_.max_segments, 1))
+    {
+        ::unlink(segments_.front().c_str());
+        segments_.pop_front();
+    }
+}
+
+/**
+ * @brief Terminate, flush, unmap and trim the current segment
+ *
+ */
+void Recorder::closeSegment_()
+{
+    if(codec_ != nullptr)
+    {
+        codec_->close();
+        codec_.reset();
+        return;
+    }
+
+    if(map_ == nullptr)
+    {
+        return;
+    }
+
+    std::memset(map_ + offset_, 0, sizeof(RecordHeader));
+    offset_ += sizeof(RecordHeader);
+
+    msync(map_, config_.segment_size, MS_SYNC);
+    munmap(map_, config_.segment_size);
+    map_ = nullptr;
+
+    if(ftruncate(fd_, offset_) != 0)
+    {
+        TRAKR_LOG_ERROR("[RECORDER] Failed to trim segment");
+    }
+    fsync(fd_);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+/**
+ * @brief Flush the pages written since the last sync
+ *
+ */
+void Recorder::sync_()
+{
+    if(codec_ != nullptr)
+    {
+        codec_->flush(true);
+        return;
+    }
+
+    if((map_ == nullptr) || (offset_ == synced_))
+    {
+        return;
+    }
+
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t begin = synced_ & ~(page - 1);
+    msync(map_ + begin, offset_ - begin, MS_SYNC);
+    synced_ = offset_;
+}
+
+Reader::Reader()
+{
+}
+
+Reader::~Reader()
+{
+    closeSegment_();
+}
+
+/**
+ * @brief Collect the segment(s) to be read
+ *
+ */
+bool Reader::open(const std::string &path, const std::string &prefix)
+{
+    closeSegment_();
+    files_.clear();
+    file_ = 0;
+
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0)
+    {
+        return false;
+    }
+
+    if(S_ISDIR(st.st_mode))
+    {
+        std::string owner = prefix;
+        size_t skipped;
+        for(const auto &segment : listSegments_(path, owner, skipped))
+        {
+            files_.push_back(segment.second);
+        }
+
+        if(skipped > 0)
+        {
+            TRAKR_LOG_WARN("[RECORDER] Skipped %zu segment(s) not of prefix %s in %s", skipped, owner, path);
+        }
+    }
+    else
+    {
+        files_.push_back(path);
+    }
+
+    while(file_ < files_.size())
+    {
+        if(openSegment_(files_[file_]))
+        {
+            return true;
+        }
+        file_++;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Decode the next record, moving across segments as required
+ *
+ */
+bool Reader::next(Entry &entry)
+{
+    while((map_ != nullptr) || (codec_ != nullptr))
+    {
+        if(codec_ != nullptr)
+        {
+            if(codec_->next(entry))
+            {
+                return true;
+            }
+        }
+        else
+        {
+            RecordHeader header;
+            if(offset_ + sizeof(RecordHeader) <= size_)
+            {
+                std::memcpy(&header, map_ + offset_, sizeof(header));
+            }
+
+            if((offset_ + sizeof(RecordHeader) <= size_) && (header.magic == RECORD_MAGIC)
+                && (offset_ + sizeof(RecordHeader) + header.size <= size_))
+            {
+                const unsigned char* payload = map_ + offset_ + sizeof(RecordHeader);
+                offset_ += sizeof(RecordHeader) + padded_(header.size);
+
+                entry.type = static_cast<RecordType>(header.type);
+                entry.seq = header.seq;
+                entry.stamp = header.stamp;
+
+                if((entry.type == RecordType::eState) && (header.size == sizeof(entry.state)))
+                {
+                    std::memcpy(&entry.state, payload, sizeof(entry.state));
+                    return true;
+                }
+                if((entry.type == RecordType::ePlan) && (header.size == sizeof(entry.plan)))
+                {
+                    std::memcpy(&entry.plan, payload, sizeof(entry.plan));
+                    return true;
+                }
+                continue;
+            }
+        }
+
+        // end of this segment
+        closeSegment_();
+        file_++;
+        while((file_ < files_.size()) && !openSegment_(files_[file_]))
+        {
+            file_++;
+        }
+    }
+
+    return false;
+}
+
+bool Reader::openSegment_(const std::string &path)
+{
+    if(hasSuffix_(path, ".trz"))
+    {
+        codec_.reset(new LogCodec::Reader());
+        if(!codec_->open(path))
+        {
+            codec_.reset();
+            return false;
+        }
+
+        header_ = SegmentHeader();
+        header_.index = static_cast<uint32_t>(file_);
+        header_.wall_ns = codec_->header().wall_ns;
+        header_.mono_ns = codec_->header().mono_ns;
+        return true;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    SegmentHeader header;
+    std::memcpy(&header, map, sizeof(header));
+    if((std::memcmp(header.magic, SegmentHeader().magic, sizeof(header.magic)) != 0)
+        || (header.version != SEGMENT_VERSION)
+        || (header.state_size != sizeof(ClientNetworkConfig::AlliedState))
+        || (header.plan_size != sizeof(ClientNetworkConfig::AlliedPlan)))
+    {
+        TRAKR_LOG_ERROR("[RECORDER] Incompatible segment %s", path);
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    header_ = header;
+    map_ = static_cast<const unsigned char*>(map);
+    size_ = st.st_size;
+    offset_ = padded_(sizeof(SegmentHeader));
+    return true;
+}
+
+void Reader::closeSegment_()
+{
+    codec_.reset();
+
+    if(map_ != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(map_), size_);
+        map_ = nullptr;
+    }
+    size_ = 0;
+    offset_ = 0;
+}
+
+};
@@ -0,0 +1,610 @@
+#include "log_codec.h"
+
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace LogCodec
+{
+
+static uint64_t zigzag_(uint64_t value)
+{
+    return (value << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63);
+}
+
+static uint64_t unzigzag_(uint64_t value)
+{
+    return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+static uint64_t mask_(int bits)
+{
+    return (bits >= 64) ? ~0ull : ((1ull << bits) - 1);
+}
+
+template <typename Packet>
+static void setupStream_(std::vector<PacketFields::Field> &fields, size_t &config_offset, size_t &config_size,
+                         const std::vector<PacketFields::Field> &all)
+{
+    static const Packet packet {};
+
+    for(const PacketFields::Field &f : all)
+    {
+        if(f.name.compare(0, 7, "config.") != 0)
+        {
+            fields.push_back(f);
+        }
+    }
+
+    config_offset = reinterpret_cast<const char*>(&packet.config) - reinterpret_cast<const char*>(&packet);
+    config_size = sizeof(packet.config);
+}
+
+Predictor::Predictor()
+{
+    setupStream_<ClientNetworkConfig::AlliedState>(streams_[0].fields, streams_[0].config_offset,
+                                                   streams_[0].config_size, PacketFields::stateFields());
+    setupStream_<ClientNetworkConfig::AlliedPlan>(streams_[1].fields, streams_[1].config_offset,
+                                                  streams_[1].config_size, PacketFields::planFields());
+
+    for(Stream &st : streams_)
+    {
+        st.channels.resize(st.fields.size());
+        st.config.resize(st.config_size);
+    }
+}
+
+void Predictor::reset()
+{
+    for(Stream &st : streams_)
+    {
+        for(Channel &ch : st.channels)
+        {
+            ch = Channel();
+        }
+        st.has_config = false;
+        st.stamp = 0;
+        st.stamp_delta = 0;
+    }
+    seq_ = 0;
+}
+
+Writer::~Writer()
+{
+    close();
+}
+
+/**
+ * @brief Create the file and write its header
+ *
+ */
+bool Writer::open(const std::string &path, uint32_t block_records, uint64_t wall_ns, uint64_t mono_ns)
+{
+    close();
+
+    file_ = fopen(path.c_str(), "wb");
+    if(file_ == nullptr)
+    {
+        return false;
+    }
+
+    FileHeader header;
+    header.block_records = block_records;
+    header.wall_ns = wall_ns;
+    header.mono_ns = mono_ns;
+    if(fwrite(&header, sizeof(header), 1, file_) != 1)
+    {
+        close();
+        return false;
+    }
+
+    block_records_ = (block_records > 0) ? block_records : 1;
+    block_ = BlockHeader();
+    buf_.clear();
+    buf_.reserve(block_records_ * 256);
+    acc_ = 0;
+    bits_ = 0;
+    bytes_ = sizeof(header);
+    return true;
+}
+
+bool Writer::write(const FlightLog::Entry &entry)
+{
+    const void* packet = (entry.type == FlightLog::RecordType::ePlan) ?
+        static_cast<const void*>(&entry.plan) : static_cast<const void*>(&entry.state);
+    return write(entry.type, packet, entry.seq, entry.stamp);
+}
+
+/**
+ * @brief Encode one record into the pending block
+ *
+ */
+bool Writer::write(FlightLog::RecordType type, const void* packet, uint64_t seq, uint64_t stamp)
+{
+    if((file_ == nullptr) || (type == FlightLog::RecordType::eNone))
+    {
+        return false;
+    }
+
+    if(block_.records == 0)
+    {
+        reset();
+        block_.first_stamp = stamp;
+    }
+
+    const bool is_plan = (type == FlightLog::RecordType::ePlan);
+    const unsigned char* p = static_cast<const unsigned char*>(packet);
+    Stream &st = streams_[is_plan ? 1 : 0];
+
+    put_(is_plan ? 1 : 0, 1);
+
+    // sequence, contiguous unless records were dropped
+    const uint64_t dseq = seq - seq_;
+    seq_ = seq;
+    if(dseq == 1)
+    {
+        put_(0, 1);
+    }
+    else
+    {
+        put_(1, 1);
+        putInt_(zigzag_(dseq));
+    }
+
+    // stamp
+    const uint64_t delta = stamp - st.stamp;
+    putInt_(zigzag_(delta - st.stamp_delta));
+    st.stamp_delta = delta;
+    st.stamp = stamp;
+
+    // config, only on change
+    if(st.has_config && (std::memcmp(st.config.data(), p + st.config_offset, st.config_size) == 0))
+    {
+        put_(0, 1);
+    }
+    else
+    {
+        put_(1, 1);
+        for(size_t i = 0; i < st.config_size; i++)
+        {
+            put_(p[st.config_offset + i], 8);
+        }
+        std::memcpy(st.config.data(), p + st.config_offset, st.config_size);
+        st.has_config = true;
+    }
+
+    // channels
+    for(size_t i = 0; i < st.fields.size(); i++)
+    {
+        const PacketFields::Field &f = st.fields[i];
+        Channel &ch = st.channels[i];
+
+        if(f.type == PacketFields::FieldType::eFloat32)
+        {
+            uint32_t value;
+            std::memcpy(&value, p + f.offset, sizeof(value));
+            putFloat_(ch, value);
+        }
+        else
+        {
+            uint64_t value;
+            std::memcpy(&value, p + f.offset, sizeof(value));
+            const uint64_t d = value - ch.prev;
+            putInt_(zigzag_(d - ch.delta));
+            ch.prev = value;
+            ch.delta = d;
+        }
+    }
+
+    block_.records++;
+    block_.last_stamp = stamp;
+
+    if(block_.records >= block_records_)
+    {
+        return flush();
+    }
+    return true;
+}
+
+/**
+ * @brief Terminate the pending block and append it to the file
+ *
+ */
+bool Writer::flush(bool sync)
+{
+    if(file_ == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    if(block_.records > 0)
+    {
+        if(bits_ > 0)
+        {
+            buf_.push_back(static_cast<unsigned char>((acc_ << (8 - bits_)) & 0xff));
+        }
+
+        block_.bytes = static_cast<uint32_t>(buf_.size());
+        ok = (fwrite(&block_, sizeof(block_), 1, file_) == 1)
+            && (buf_.empty() || (fwrite(buf_.data(), buf_.size(), 1, file_) == 1));
+        bytes_ += sizeof(block_) + buf_.size();
+
+        block_ = BlockHeader();
+        buf_.clear();
+        acc_ = 0;
+        bits_ = 0;
+    }
+
+    fflush(file_);
+    if(sync)
+    {
+        fsync(fileno(file_));
+    }
+    return ok;
+}
+
+void Writer::close()
+{
+    if(file_ == nullptr)
+    {
+        return;
+    }
+
+    flush(true);
+    fclose(file_);
+    file_ = nullptr;
+}
+
+/**
+ * @brief Append the lowest "bits" bits of value (msb first)
+ *
+ */
+void Writer::put_(uint64_t value, int bits)
+{
+    if(bits > 32)
+    {
+        put_(value >> 32, bits - 32);
+        put_(value, 32);
+        return;
+    }
+
+    acc_ = (acc_ << bits) | (value & mask_(bits));
+    bits_ += bits;
+    while(bits_ >= 8)
+    {
+        bits_ -= 8;
+        buf_.push_back(static_cast<unsigned char>((acc_ >> bits_) & 0xff));
+    }
+}
+
+/**
+ * @brief Variable length unsigned integer : 0 | 10+8 | 110+16 | 1110+32 | 1111+64
+ *
+ */
+void Writer::putInt_(uint64_t value)
+{
+    if(value == 0)
+    {
+        put_(0, 1);
+    }
+    else if(value < (1ull << 8))
+    {
+        put_(0x2, 2);
+        put_(value, 8);
+    }
+    else if(value < (1ull << 16))
+    {
+        put_(0x6, 3);
+        put_(value, 16);
+    }
+    else if(value < (1ull << 32))
+    {
+        put_(0xe, 4);
+        put_(value, 32);
+    }
+    else
+    {
+        put_(0xf, 4);
+        put_(value, 64);
+    }
+}
+
+/**
+ * @brief XOR against the previous value : 0 | 10+bits in window | 11+lead(5)+len-1(5)+bits
+ *
+ */
+void Writer::putFloat_(Channel &ch, uint32_t value)
+{
+    const uint32_t x = value ^ static_cast<uint32_t>(ch.prev);
+    ch.prev = value;
+
+    if(x == 0)
+    {
+        put_(0, 1);
+        return;
+    }
+
+    const int lead = __builtin_clz(x);
+    const int trail = __builtin_ctz(x);
+
+    if(ch.window && (lead >= ch.lead) && (trail >= ch.trail))
+    {
+        put_(0x2, 2);
+        put_(x >> ch.trail, 32 - ch.lead - ch.trail);
+        return;
+    }
+
+    const int len = 32 - lead - trail;
+    put_(0x3, 2);
+    put_(lead, 5);
+    put_(len - 1, 5);
+    put_(x >> trail, len);
+
+    ch.lead = lead;
+    ch.trail = trail;
+    ch.window = true;
+}
+
+Reader::~Reader()
+{
+    close();
+}
+
+/**
+ * @brief Map the file and index its blocks from their headers
+ *
+ */
+bool Reader::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if((fstat(fd, &st) != 0) || (static_cast<size_t>(st.st_size) < sizeof(FileHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    map_ = static_cast<const unsigned char*>(map);
+    size_ = st.st_size;
+
+    std::memcpy(&header_, map_, sizeof(header_));
+    if((std::memcmp(header_.magic, FileHeader().magic, sizeof(header_.magic)) != 0)
+        || (header_.version != FILE_VERSION)
+        || (header_.state_size != sizeof(ClientNetworkConfig::AlliedState))
+        || (header_.plan_size != sizeof(ClientNetworkConfig::AlliedPlan)))
+    {
+        std::cout << "[CODEC] Incompatible file " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // a block cut short (crash while writing) ends the file
+    size_t offset = sizeof(FileHeader);
+    while(offset + sizeof(BlockHeader) <= size_)
+    {
+        BlockHeader block;
+        std::memcpy(&block, map_ + offset, sizeof(block));
+        if((block.magic != BLOCK_MAGIC) || (offset + sizeof(block) + block.bytes > size_))
+        {
+            break;
+        }
+
+        BlockInfo info;
+        info.offset = offset;
+        info.records = block.records;
+        info.bytes = block.bytes;
+        info.first_stamp = block.first_stamp;
+        info.last_stamp = block.last_stamp;
+        blocks_.push_back(info);
+
+        offset += sizeof(block) + block.bytes;
+    }
+
+    startBlock_(0);
+    return true;
+}
+
+void Reader::close()
+{
+    if(map_ != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(map_), size_);
+        map_ = nullptr;
+    }
+    size_ = 0;
+    blocks_.clear();
+    block_ = 0;
+    remaining_ = 0;
+}
+
+/**
+ * @brief Decode the next record, moving across blocks as required
+ *
+ */
+bool Reader::next(FlightLog::Entry &entry)
+{
+    while(remaining_ == 0)
+    {
+        if(!startBlock_(block_ + 1))
+        {
+            return false;
+        }
+    }
+
+    const bool is_plan = (get_(1) != 0);
+    Stream &st = streams_[is_plan ? 1 : 0];
+    unsigned char* p = is_plan ?
+        reinterpret_cast<unsigned char*>(&entry.plan) : reinterpret_cast<unsigned char*>(&entry.state);
+
+    if(get_(1) != 0)
+    {
+        seq_ += unzigzag_(getInt_());
+    }
+    else
+    {
+        seq_ += 1;
+    }
+
+    st.stamp_delta += unzigzag_(getInt_());
+    st.stamp += st.stamp_delta;
+
+    if(get_(1) != 0)
+    {
+        for(size_t i = 0; i < st.config_size; i++)
+        {
+            st.config[i] = static_cast<unsigned char>(get_(8));
+        }
+        st.has_config = true;
+    }
+    std::memcpy(p + st.config_offset, st.config.data(), st.config_size);
+
+    for(size_t i = 0; i < st.fields.size(); i++)
+    {
+        const PacketFields::Field &f = st.fields[i];
+        Channel &ch = st.channels[i];
+
+        if(f.type == PacketFields::FieldType::eFloat32)
+        {
+            uint32_t value = getFloat_(ch);
+            std::memcpy(p + f.offset, &value, sizeof(value));
+        }
+        else
+        {
+            ch.delta += unzigzag_(getInt_());
+            ch.prev += ch.delta;
+            std::memcpy(p + f.offset, &ch.prev, sizeof(ch.prev));
+        }
+    }
+
+    entry.type = is_plan ? FlightLog::RecordType::ePlan : FlightLog::RecordType::eState;
+    entry.seq = seq_;
+    entry.stamp = st.stamp;
+
+    remaining_--;
+    return true;
+}
+
+/**
+ * @brief Jump to the first block ending at or after the stamp
+ *
+ */
+bool Reader::seek(uint64_t stamp)
+{
+    for(size_t i = 0; i < blocks_.size(); i++)
+    {
+        if(blocks_[i].last_stamp >= stamp)
+        {
+            return startBlock_(i);
+        }
+    }
+
+    remaining_ = 0;
+    block_ = blocks_.size();
+    return false;
+}
+
+bool Reader::startBlock_(size_t index)
+{
+    if(index >= blocks_.size())
+    {
+        return false;
+    }
+
+    block_ = index;
+    reset();
+
+    data_ = map_ + blocks_[index].offset + sizeof(BlockHeader);
+    data_size_ = blocks_[index].bytes;
+    pos_ = 0;
+    acc_ = 0;
+    bits_ = 0;
+    remaining_ = blocks_[index].records;
+    return true;
+}
+
+uint64_t Reader::get_(int bits)
+{
+    if(bits > 32)
+    {
+        const uint64_t high = get_(bits - 32);
+        return (high << 32) | get_(32);
+    }
+
+    while(bits_ < bits)
+    {
+        acc_ = (acc_ << 8) | ((pos_ < data_size_) ? data_[pos_] : 0);
+        pos_++;
+        bits_ += 8;
+    }
+
+    bits_ -= bits;
+    return (acc_ >> bits_) & mask_(bits);
+}
+
+uint64_t Reader::getInt_()
+{
+    if(get_(1) == 0)
+    {
+        return 0;
+    }
+    if(get_(1) == 0)
+    {
+        return get_(8);
+    }
+    if(get_(1) == 0)
+    {
+        return get_(16);
+    }
+    if(get_(1) == 0)
+    {
+        return get_(32);
+    }
+    return get_(64);
+}
+
+uint32_t Reader::getFloat_(Channel &ch)
+{
+    if(get_(1) == 0)
+    {
+        return static_cast<uint32_t>(ch.prev);
+    }
+
+    uint32_t x;
+    if(get_(1) == 0)
+    {
+        x = static_cast<uint32_t>(get_(32 - ch.lead - ch.trail)) << ch.trail;
+    }
+    else
+    {
+        const int lead = static_cast<int>(get_(5));
+        const int len = static_cast<int>(get_(5)) + 1;
+        const int trail = 32 - lead - len;
+        x = static_cast<uint32_t>(get_(len)) << trail;
+        ch.lead = lead;
+        ch.trail = trail;
+    }
+
+    const uint32_t value = static_cast<uint32_t>(ch.prev) ^ x;
+    ch.prev = value;
+    return value;
+}
+
+};
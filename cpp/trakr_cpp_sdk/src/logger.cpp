@@ -0,0 +1,490 @@
+#include "logger.h"
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "clock_source.h"
+#include "spsc_queue.h"
+
+namespace Log
+{
+
+std::atomic<uint8_t> level_ {eInfo};
+
+std::atomic<uint64_t> rate_limit_ {1000000000ull};
+
+/// @brief records kept per thread before dropping
+static constexpr size_t RING_SIZE = 512;
+
+/**
+ * @brief Records of one thread, released when the thread exits and removed
+ * by the background thread once drained
+ *
+ */
+struct Ring
+{
+    Ring() : queue(RING_SIZE)
+    {
+    }
+
+    SpscQueue<Record> queue;
+
+    /// @brief set by the owning thread on exit
+    std::atomic<bool> released {false};
+
+    /// @brief released and emptied (background thread only)
+    bool drained = false;
+};
+
+/**
+ * @brief Background thread draining the rings of every thread
+ *
+ */
+class Core
+{
+    public:
+
+    Core()
+    {
+        sink_ = [](Level, const char* line)
+        {
+            fputs(line, stdout);
+            fputc('\n', stdout);
+        };
+        running_.store(true);
+        thread_ = std::thread(&Core::loop_, this);
+    }
+
+    /// @brief ring of the calling thread, created on its first record
+    /// @return nullptr once the thread is exiting (records are then written synchronously)
+    SpscQueue<Record>* ring()
+    {
+        if(exited_)
+        {
+            return nullptr;
+        }
+        if(ring_ == nullptr)
+        {
+            std::shared_ptr<Ring> ring = std::make_shared<Ring>();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                rings_.push_back(ring);
+                rings_version_++;
+            }
+            ring_ = ring.get();
+            owner_.ring = ring_;
+        }
+        return &ring_->queue;
+    }
+
+    void setSink(std::function<void(Level, const char*)> sink)
+    {
+        std::lock_guard<std::mutex> lock(sink_mutex_);
+        sink_ = sink;
+    }
+
+    /// @brief stop the thread after a last drain; later records are
+    /// written synchronously
+    void stop()
+    {
+        if(running_.exchange(false))
+        {
+            thread_.join();
+        }
+        drain_();
+    }
+
+    bool isRunning() const
+    {
+        return running_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief format and hand one record to the sink
+    void emit(const Record &record);
+
+    /// @brief consume every ring once
+    /// @return records emitted
+    size_t drain_();
+
+    std::atomic<uint64_t> seq {0};
+
+    std::atomic<uint64_t> produced {0};
+
+    std::atomic<uint64_t> consumed {0};
+
+    std::atomic<uint64_t> dropped {0};
+
+    private:
+
+    /// @brief releases the ring of its thread on exit
+    struct RingOwner
+    {
+        Ring* ring = nullptr;
+
+        ~RingOwner()
+        {
+            exited_ = true;
+            ring_ = nullptr;
+            if(ring != nullptr)
+            {
+                ring->released.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    static thread_local Ring* ring_;
+
+    static thread_local bool exited_;
+
+    static thread_local RingOwner owner_;
+
+    std::mutex mutex_;
+
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    /// @brief bumped whenever rings_ changes, under mutex_
+    uint64_t rings_version_ = 0;
+
+    std::mutex sink_mutex_;
+
+    std::function<void(Level, const char*)> sink_;
+
+    std::atomic<bool> running_ {false};
+
+    std::thread thread_;
+
+    /// @brief used by the draining thread only
+    std::vector<std::shared_ptr<Ring>> local_;
+    uint64_t local_version_ = 0;
+    std::vector<Record> pending_;
+    uint64_t reported_dropped_ = 0;
+
+    /// @brief formatting buffer, under sink_mutex_
+    std::string line_;
+
+    void loop_()
+    {
+        while(running_.load())
+        {
+            if(drain_() == 0)
+            {
+                usleep(2000);
+            }
+        }
+    }
+};
+
+thread_local Ring* Core::ring_ = nullptr;
+
+thread_local bool Core::exited_ = false;
+
+thread_local Core::RingOwner Core::owner_;
+
+/**
+ * @brief Never destroyed, so that objects logging from their destructor
+ * outlive it safely; stopped at exit instead
+ *
+ */
+static Core& core_()
+{
+    static Core* core = []()
+    {
+        Core* created = new Core();
+        atexit([]()
+        {
+            core_().stop();
+        });
+        return created;
+    }();
+    return *core;
+}
+
+/**
+ * @brief Append one conversion, with the argument cast to what it expects
+ *
+ */
+static void convert_(std::string &out, std::string &spec, char conversion, const Record &record, const Arg* arg)
+{
+    char buffer[128];
+    int n = 0;
+
+    if(arg == nullptr)
+    {
+        out += spec;
+        out += conversion;
+        return;
+    }
+
+    auto asDouble = [arg]()
+    {
+        return (arg->type == Arg::eDouble) ? arg->d : (arg->type == Arg::eInt) ? static_cast<double>(arg->i)
+                                                                                : static_cast<double>(arg->u);
+    };
+    auto asInt = [arg]()
+    {
+        return (arg->type == Arg::eDouble) ? static_cast<long long>(arg->d) : static_cast<long long>(arg->i);
+    };
+
+    switch(conversion)
+    {
+        case 'd':
+        case 'i':
+            spec += "ll";
+            spec += conversion;
+            n = snprintf(buffer, sizeof(buffer), spec.c_str(), asInt());
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec += "ll";
+            spec += conversion;
+            n = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(asInt()));
+            break;
+
+        case 'c':
+            spec += conversion;
+            n = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(asInt()));
+            break;
+
+        case 's':
+            if(arg->type != Arg::eText)
+            {
+                spec = "%.9g";
+                n = snprintf(buffer, sizeof(buffer), spec.c_str(), asDouble());
+                break;
+            }
+            spec += conversion;
+            n = snprintf(buffer, sizeof(buffer), spec.c_str(), record.text + arg->text);
+            break;
+
+        case 'p':
+            spec += conversion;
+            n = snprintf(buffer, sizeof(buffer), spec.c_str(), arg->p);
+            break;
+
+        default:
+            spec += conversion;
+            n = snprintf(buffer, sizeof(buffer), spec.c_str(), asDouble());
+            break;
+    }
+
+    if(n > 0)
+    {
+        out.append(buffer, std::min<size_t>(n, sizeof(buffer) - 1));
+    }
+}
+
+/**
+ * @brief printf-style formatting of a captured record
+ *
+ */
+static void format_(std::string &out, const Record &record)
+{
+    out.clear();
+
+    std::string spec;
+    int next = 0;
+    for(const char* c = record.format; *c != '\0'; c++)
+    {
+        if(*c != '%')
+        {
+            out += *c;
+            continue;
+        }
+
+        c++;
+        if(*c == '%')
+        {
+            out += '%';
+            continue;
+        }
+
+        // flags, width and precision are kept; length modifiers are replaced
+        spec = "%";
+        while((*c != '\0') && strchr("-+ #0123456789.", *c) != nullptr)
+        {
+            spec += *c++;
+        }
+        while((*c != '\0') && strchr("hljztL", *c) != nullptr)
+        {
+            c++;
+        }
+        if(*c == '\0')
+        {
+            out += spec;
+            break;
+        }
+
+        const Arg* arg = (next < record.count) ? &record.args[next] : nullptr;
+        next++;
+        convert_(out, spec, *c, record, arg);
+    }
+
+    if(record.suppressed > 0)
+    {
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), " (%u similar messages suppressed)", record.suppressed);
+        out += suffix;
+    }
+}
+
+void Core::emit(const Record &record)
+{
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    format_(line_, record);
+    sink_(record.level, line_.c_str());
+}
+
+size_t Core::drain_()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(local_version_ != rings_version_)
+        {
+            local_ = rings_;
+            local_version_ = rings_version_;
+        }
+    }
+
+    pending_.clear();
+    bool drained = false;
+    for(const std::shared_ptr<Ring> &ring : local_)
+    {
+        // released before this drain : nothing is pushed after it
+        const bool released = ring->released.load(std::memory_order_acquire);
+        while(Record* record = ring->queue.front())
+        {
+            pending_.push_back(*record);
+            ring->queue.pop();
+        }
+        ring->drained = released;
+        drained = drained || released;
+    }
+
+    // rings of the threads that exited
+    if(drained)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring> &ring)
+        {
+            return ring->drained;
+        }), rings_.end());
+        rings_version_++;
+    }
+
+    // interleave the threads in the order the records were made
+    std::sort(pending_.begin(), pending_.end(), [](const Record &a, const Record &b)
+    {
+        return a.seq < b.seq;
+    });
+
+    for(const Record &record : pending_)
+    {
+        emit(record);
+    }
+
+    const uint64_t lost = dropped.load(std::memory_order_relaxed);
+    if(lost != reported_dropped_)
+    {
+        char line[64];
+        snprintf(line, sizeof(line), "[LOG] %llu messages dropped", static_cast<unsigned long long>(lost - reported_dropped_));
+        reported_dropped_ = lost;
+        std::lock_guard<std::mutex> lock(sink_mutex_);
+        sink_(eWarn, line);
+    }
+
+    if(!pending_.empty())
+    {
+        fflush(stdout);
+    }
+    consumed.fetch_add(pending_.size(), std::memory_order_release);
+    return pending_.size();
+}
+
+void setLevel(Level level)
+{
+    level_.store(level, std::memory_order_relaxed);
+}
+
+void setRateLimit(double seconds)
+{
+    rate_limit_.store(static_cast<uint64_t>(std::max(seconds, 0.0) * 1e9), std::memory_order_relaxed);
+}
+
+void setSink(std::function<void(Level, const char*)> sink)
+{
+    core_().setSink(sink);
+}
+
+void flush()
+{
+    Core &core = core_();
+    const uint64_t target = core.produced.load(std::memory_order_acquire);
+    while(core.isRunning() && (core.consumed.load(std::memory_order_acquire) < target))
+    {
+        usleep(1000);
+    }
+}
+
+uint64_t dropped()
+{
+    return core_().dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t now()
+{
+    return SystemClock::monotonic();
+}
+
+/// @brief record being written by the calling thread
+static thread_local Record* pending_record_ = nullptr;
+
+/// @brief stand-in record once the background thread has stopped, or the
+/// calling thread released its ring
+static thread_local Record late_record_;
+
+Record* beginRecord_()
+{
+    Core &core = core_();
+    SpscQueue<Record>* ring = core.isRunning() ? core.ring() : nullptr;
+
+    if(ring == nullptr)
+    {
+        pending_record_ = &late_record_;
+    }
+    else
+    {
+        pending_record_ = ring->beginPush();
+        if(pending_record_ == nullptr)
+        {
+            core.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    pending_record_->seq = core.seq.fetch_add(1, std::memory_order_relaxed);
+    return pending_record_;
+}
+
+void endRecord_()
+{
+    Core &core = core_();
+
+    if(pending_record_ == &late_record_)
+    {
+        core.emit(late_record_);
+        fflush(stdout);
+        return;
+    }
+    core.ring()->endPush();
+    core.produced.fetch_add(1, std::memory_order_release);
+}
+
+};
@@ -0,0 +1,499 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+namespace Metrics
+{
+
+Histogram::Histogram(const Info &info, const std::vector<double> &bounds)
+    : info_(info), bounds_(bounds), buckets_(new std::atomic<uint64_t>[bounds.size() + 1])
+{
+    for(size_t i = 0; i <= bounds_.size(); i++)
+    {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<double> latencyBuckets()
+{
+    return {0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.002, 0.0025, 0.003, 0.005, 0.01, 0.025, 0.1};
+}
+
+/**
+ * @brief Find a metric of the given name and labels
+ *
+ */
+template <typename T>
+static T* find_(const std::vector<std::unique_ptr<T>> &metrics, const std::string &name, const std::string &labels)
+{
+    for(const std::unique_ptr<T> &metric : metrics)
+    {
+        if((metric->info().name == name) && (metric->info().labels == labels))
+        {
+            return metric.get();
+        }
+    }
+    return nullptr;
+}
+
+Counter& Registry::counter(const std::string &name, const std::string &help, const std::string &labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Counter* metric = find_(counters_, name, labels);
+    if(metric == nullptr)
+    {
+        counters_.emplace_back(new Counter({name, help, labels}));
+        order_.push_back({eCounter, counters_.size() - 1});
+        metric = counters_.back().get();
+    }
+    return *metric;
+}
+
+Gauge& Registry::gauge(const std::string &name, const std::string &help, const std::string &labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Gauge* metric = find_(gauges_, name, labels);
+    if(metric == nullptr)
+    {
+        gauges_.emplace_back(new Gauge({name, help, labels}));
+        order_.push_back({eGauge, gauges_.size() - 1});
+        metric = gauges_.back().get();
+    }
+    return *metric;
+}
+
+Histogram& Registry::histogram(const std::string &name, const std::string &help, const std::string &labels,
+                               const std::vector<double> &bounds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Histogram* metric = find_(histograms_, name, labels);
+    if(metric == nullptr)
+    {
+        histograms_.emplace_back(new Histogram({name, help, labels}, bounds));
+        order_.push_back({eHistogram, histograms_.size() - 1});
+        metric = histograms_.back().get();
+    }
+    return *metric;
+}
+
+static void appendf_(std::string &out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf_(std::string &out, const char* format, ...)
+{
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if(n > 0)
+    {
+        out.append(line, std::min<size_t>(n, sizeof(line) - 1));
+    }
+}
+
+/**
+ * @brief name{labels,extra} with the braces left out when empty
+ *
+ */
+static void series_(std::string &out, const std::string &name, const char* suffix,
+                    const std::string &labels, const std::string &extra)
+{
+    out += name;
+    out += suffix;
+    if(labels.empty() && extra.empty())
+    {
+        return;
+    }
+    out += '{';
+    out += labels;
+    if(!labels.empty() && !extra.empty())
+    {
+        out += ',';
+    }
+    out += extra;
+    out += '}';
+}
+
+const Info& Registry::info_(const Entry &entry) const
+{
+    if(entry.type == eCounter)
+    {
+        return counters_[entry.index]->info();
+    }
+    if(entry.type == eGauge)
+    {
+        return gauges_[entry.index]->info();
+    }
+    return histograms_[entry.index]->info();
+}
+
+/**
+ * @brief Metrics sharing a name (e.g. one per robot) are grouped under
+ * a single HELP and TYPE, as the format requires
+ *
+ */
+void Registry::writePrometheus(std::string &out) const
+{
+    static const char* types[] = {"counter", "gauge", "histogram"};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out.clear();
+    std::vector<bool> written(order_.size(), false);
+    char extra[64];
+
+    for(size_t first = 0; first < order_.size(); first++)
+    {
+        if(written[first])
+        {
+            continue;
+        }
+
+        const Info &family = info_(order_[first]);
+        appendf_(out, "# HELP %s %s\n# TYPE %s %s\n", family.name.c_str(), family.help.c_str(),
+                 family.name.c_str(), types[order_[first].type]);
+
+        for(size_t k = first; k < order_.size(); k++)
+        {
+            const Entry &entry = order_[k];
+            if(written[k] || (info_(entry).name != family.name))
+            {
+                continue;
+            }
+            written[k] = true;
+
+            if(entry.type == eCounter)
+            {
+                const Counter &metric = *counters_[entry.index];
+                series_(out, metric.info().name, "", metric.info().labels, "");
+                appendf_(out, " %llu\n", static_cast<unsigned long long>(metric.value()));
+            }
+            else if(entry.type == eGauge)
+            {
+                const Gauge &metric = *gauges_[entry.index];
+                series_(out, metric.info().name, "", metric.info().labels, "");
+                appendf_(out, " %.9g\n", metric.value());
+            }
+            else
+            {
+                const Histogram &metric = *histograms_[entry.index];
+
+                uint64_t count = 0;
+                for(size_t i = 0; i <= metric.bounds().size(); i++)
+                {
+                    count += metric.bucket(i);
+                    if(i < metric.bounds().size())
+                    {
+                        snprintf(extra, sizeof(extra), "le=\"%.9g\"", metric.bounds()[i]);
+                    }
+                    else
+                    {
+                        snprintf(extra, sizeof(extra), "le=\"+Inf\"");
+                    }
+                    series_(out, metric.info().name, "_bucket", metric.info().labels, extra);
+                    appendf_(out, " %llu\n", static_cast<unsigned long long>(count));
+                }
+                series_(out, metric.info().name, "_sum", metric.info().labels, "");
+                appendf_(out, " %.9g\n", metric.sum());
+                series_(out, metric.info().name, "_count", metric.info().labels, "");
+                appendf_(out, " %llu\n", static_cast<unsigned long long>(count));
+            }
+        }
+    }
+}
+
+LinkMetrics::LinkMetrics(Registry &registry, const std::string &labels, double deadline)
+    : cycles(registry.counter("trakr_cycles_total", "Calls to Robot::run()", labels)),
+      failures(registry.counter("trakr_cycle_failures_total", "Calls to Robot::run() that failed", labels)),
+      deadline_misses(registry.counter("trakr_deadline_misses_total", "Cycle periods above the deadline", labels)),
+      packets_received(registry.counter("trakr_packets_received_total", "States received from the robot", labels)),
+      packets_sent(registry.counter("trakr_packets_sent_total", "Plans sent to the robot", labels)),
+      handshakes_ok(registry.counter("trakr_handshakes_total", "Outcomes of setup() and bring-up",
+                                     labels + (labels.empty() ? "" : ",") + "result=\"ok\"")),
+      handshakes_failed(registry.counter("trakr_handshakes_total", "Outcomes of setup() and bring-up",
+                                         labels + (labels.empty() ? "" : ",") + "result=\"failed\"")),
+      configs_accepted(registry.counter("trakr_config_acks_total", "Configuration changes acknowledged by the robot",
+                                        labels + (labels.empty() ? "" : ",") + "result=\"accepted\"")),
+      configs_rejected(registry.counter("trakr_config_acks_total", "Configuration changes acknowledged by the robot",
+                                        labels + (labels.empty() ? "" : ",") + "result=\"rejected\"")),
+      connected(registry.gauge("trakr_connected", "1 while the link to the robot is up", labels)),
+      cycle_period(registry.histogram("trakr_cycle_period_seconds", "Time between consecutive calls to Robot::run()", labels)),
+      state_interval(registry.histogram("trakr_state_interval_seconds", "Time between consecutive states from the robot", labels)),
+      cycle_time(registry.histogram("trakr_cycle_time_seconds", "Time spent inside Robot::run()", labels)),
+      deadline(deadline)
+{
+}
+
+Exporter::~Exporter()
+{
+    running_.store(false);
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool Exporter::start()
+{
+    if(running_.load())
+    {
+        return true;
+    }
+
+    if(!open_())
+    {
+        return false;
+    }
+
+    running_.store(true);
+    thread_ = std::thread(&Exporter::loop_, this);
+    return true;
+}
+
+void Exporter::stop()
+{
+    if(!running_.exchange(false))
+    {
+        return;
+    }
+    thread_.join();
+    close_();
+}
+
+FileExporter::~FileExporter()
+{
+    stop();
+}
+
+bool FileExporter::open_()
+{
+    std::string text;
+    return dump_(text);
+}
+
+/**
+ * @brief Dump at every period, sleeping in short steps to stop promptly
+ *
+ */
+void FileExporter::loop_()
+{
+    std::string text;
+    const uint64_t period = static_cast<uint64_t>(period_ * 1e9);
+    uint64_t next = now() + period;
+
+    while(running_.load())
+    {
+        if(now() < next)
+        {
+            usleep(10000);
+            continue;
+        }
+        next += period;
+        dump_(text);
+    }
+}
+
+void FileExporter::close_()
+{
+    std::string text;
+    dump_(text);
+}
+
+/**
+ * @brief Write to a temporary file, then rename over the target
+ *
+ */
+bool FileExporter::dump_(std::string &text)
+{
+    registry_.writePrometheus(text);
+
+    const std::string tmp = path_ + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "w");
+    if(file == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = (fwrite(text.data(), 1, text.size(), file) == text.size());
+    ok = (fclose(file) == 0) && ok;
+    if(!ok || (rename(tmp.c_str(), path_.c_str()) != 0))
+    {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+HttpExporter::~HttpExporter()
+{
+    stop();
+    close_();
+}
+
+bool HttpExporter::open_()
+{
+    if(!address_.empty() && (address_[0] == '/'))
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if(address_.size() >= sizeof(addr.sun_path))
+        {
+            return false;
+        }
+        strcpy(addr.sun_path, address_.c_str());
+        unlink(addr.sun_path);
+
+        fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if((fd_ < 0) || (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0))
+        {
+            close_();
+            return false;
+        }
+    }
+    else
+    {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+
+        std::string host = "127.0.0.1";
+        std::string port = address_;
+        size_t colon = address_.rfind(':');
+        if(colon != std::string::npos)
+        {
+            host = address_.substr(0, colon);
+            port = address_.substr(colon + 1);
+        }
+        addr.sin_port = htons(static_cast<uint16_t>(atoi(port.c_str())));
+        if(inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        {
+            return false;
+        }
+
+        fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int yes = 1;
+        if((fd_ < 0) || (setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) != 0) ||
+           (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0))
+        {
+            close_();
+            return false;
+        }
+    }
+
+    if(listen(fd_, 8) != 0)
+    {
+        close_();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief One request per connection; poll with a timeout to notice stop()
+ *
+ */
+void HttpExporter::loop_()
+{
+    std::string text;
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+
+    while(running_.load())
+    {
+        if(poll(&pfd, 1, 100) <= 0)
+        {
+            continue;
+        }
+
+        int client = accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if(client < 0)
+        {
+            continue;
+        }
+        serve_(client, text);
+        close(client);
+    }
+}
+
+void HttpExporter::close_()
+{
+    if(fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+        if(!address_.empty() && (address_[0] == '/'))
+        {
+            unlink(address_.c_str());
+        }
+    }
+}
+
+/**
+ * @brief Answer GET with the metrics; anything else with 405
+ *
+ */
+void HttpExporter::serve_(int client, std::string &text)
+{
+    struct timeval timeout = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // only the request line matters; the rest is drained up to the limit
+    char request[4096];
+    size_t size = 0;
+    while(size < sizeof(request) - 1)
+    {
+        ssize_t n = recv(client, request + size, sizeof(request) - 1 - size, 0);
+        if(n <= 0)
+        {
+            break;
+        }
+        size += n;
+        request[size] = '\0';
+        if(strstr(request, "\r\n\r\n") != nullptr)
+        {
+            break;
+        }
+    }
+    request[size] = '\0';
+
+    std::string response;
+    if(strncmp(request, "GET ", 4) == 0)
+    {
+        registry_.writePrometheus(text);
+        appendf_(response, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: %zu\r\nConnection: close\r\n\r\n", text.size());
+        response += text;
+    }
+    else
+    {
+        response = "HTTP/1.0 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+
+    size_t sent = 0;
+    while(sent < response.size())
+    {
+        ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if(n <= 0)
+        {
+            break;
+        }
+        sent += n;
+    }
+}
+
+};
@@ -0,0 +1,128 @@
+#include "observation.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Observation
+{
+
+static_assert(decltype(AlliedDataTypes::JointState::pos)::RowsAtCompileTime == NDOF, "State joints differ from NDOF");
+
+/// @brief first value after the joint fields
+static constexpr size_t TORSO_ = 5 * NDOF;
+
+const Field FIELDS[FIELD_COUNT] =
+{
+    {"joint.pos", 0 * NDOF, NDOF},
+    {"joint.vel", 1 * NDOF, NDOF},
+    {"joint.tor", 2 * NDOF, NDOF},
+    {"joint.kp", 3 * NDOF, NDOF},
+    {"joint.kd", 4 * NDOF, NDOF},
+    {"torso.pos", TORSO_, 6},
+    {"torso.vel", TORSO_ + 6, 6},
+    {"imu.acc", TORSO_ + 12, 3},
+    {"imu.gyro", TORSO_ + 15, 3},
+    {"imu.mag", TORSO_ + 18, 3},
+    {"imu.euler", TORSO_ + 21, 3},
+};
+
+static_assert(TORSO_ + 24 == SIZE, "FIELDS do not cover SIZE");
+
+template <typename Vector>
+static inline float* put_(const Vector &values, float* out)
+{
+    for(int i = 0; i < values.size(); i++)
+    {
+        *out++ = static_cast<float>(values[i]);
+    }
+    return out;
+}
+
+/**
+ * @brief Pack the continuous data of state, in the order of FIELDS
+ *
+ */
+void pack(const AlliedDataTypes::State &state, float* out)
+{
+    out = put_(state.joint.pos, out);
+    out = put_(state.joint.vel, out);
+    out = put_(state.joint.tor, out);
+    out = put_(state.joint.kp, out);
+    out = put_(state.joint.kd, out);
+    out = put_(state.torso.pos, out);
+    out = put_(state.torso.vel, out);
+    out = put_(state.imu.acc, out);
+    out = put_(state.imu.gyro, out);
+    out = put_(state.imu.mag, out);
+    put_(state.imu.euler, out);
+}
+
+/**
+ * @brief Allocate the ring for length observations
+ *
+ */
+void History::reset(size_t length)
+{
+    capacity_ = (length > 0) ? length + 1 : 0;
+    rows_.assign(capacity_ * SIZE, 0.0f);
+    stamps_.assign(capacity_, 0);
+    count_.store(0);
+}
+
+/**
+ * @brief Write the next slot, then publish it
+ *
+ */
+void History::push(const AlliedDataTypes::State &state)
+{
+    if(capacity_ == 0)
+    {
+        return;
+    }
+
+    const uint64_t count = count_.load(std::memory_order_relaxed);
+    const size_t slot = count % capacity_;
+    pack(state, &rows_[slot * SIZE]);
+    stamps_[slot] = state.joint.timestamp;
+    count_.store(count + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Copy the latest observations; retried if the writer went round
+ * the ring over the oldest ones meanwhile
+ *
+ */
+size_t History::copy(float* rows, uint64_t* stamps, size_t count) const
+{
+    if(capacity_ == 0)
+    {
+        return 0;
+    }
+
+    while(true)
+    {
+        const uint64_t end = count_.load(std::memory_order_acquire);
+        const uint64_t n = std::min<uint64_t>({count, end, capacity_ - 1});
+        const uint64_t first = end - n;
+
+        for(uint64_t i = 0; i < n; i++)
+        {
+            const size_t slot = (first + i) % capacity_;
+            std::memcpy(rows + i * SIZE, &rows_[slot * SIZE], SIZE * sizeof(float));
+            if(stamps != nullptr)
+            {
+                stamps[i] = stamps_[slot];
+            }
+        }
+
+        // the writer may now be inside the slot of count_, i.e. of count_ - capacity_
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t now = count_.load(std::memory_order_relaxed);
+        if(now + 1 <= first + capacity_)
+        {
+            return n;
+        }
+    }
+}
+
+};
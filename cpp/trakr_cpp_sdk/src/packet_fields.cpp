@@ -0,0 +1,154 @@
+#include "packet_fields.h"
+
+namespace PacketFields
+{
+
+/**
+ * @brief Appends channels while walking a packet instance
+ *
+ */
+template <typename Packet>
+class FieldBuilder
+{
+    public:
+
+    FieldBuilder(const Packet &packet, std::vector<Field> &fields)
+        : base_(reinterpret_cast<const char*>(&packet)), fields_(fields)
+    {
+    }
+
+    void add(const std::string &name, const float &value)
+    {
+        push_(name, FieldType::eFloat32, &value);
+    }
+
+    void add(const std::string &name, const uint64_t &value)
+    {
+        push_(name, FieldType::eUInt64, &value);
+    }
+
+    void add(const std::string &name, const int &value)
+    {
+        push_(name, FieldType::eInt32, &value);
+    }
+
+    void add(const std::string &name, const bool &value)
+    {
+        push_(name, FieldType::eBool, &value);
+    }
+
+    template <size_t N>
+    void add(const std::string &name, const std::array<float, N> &values)
+    {
+        for(size_t i = 0; i < N; i++)
+        {
+            add(name + "." + std::to_string(i), values[i]);
+        }
+    }
+
+    private:
+
+    const char* base_;
+
+    std::vector<Field> &fields_;
+
+    void push_(const std::string &name, FieldType type, const void* member)
+    {
+        fields_.push_back({name, type, static_cast<size_t>(reinterpret_cast<const char*>(member) - base_)});
+    }
+};
+
+template <typename Packet>
+static void addConfig_(FieldBuilder<Packet> &b, const SocketDataTypes::Config &c)
+{
+    b.add("config.status", c.status);
+    b.add("config.master.shutdown", c.master.shutdown);
+    b.add("config.master.exit", c.master.exit);
+    b.add("config.master.killed", c.master.killed);
+    b.add("config.motion.planner", c.motion.planner);
+    b.add("config.motion.sequence.type", c.motion.sequence.type);
+    b.add("config.motion.sequence.seq", c.motion.sequence.seq);
+    b.add("config.motion.strategy.type", c.motion.strategy.type);
+    b.add("config.motion.strategy.seq", c.motion.strategy.seq);
+}
+
+size_t typeSize(FieldType type)
+{
+    switch (type)
+    {
+        case FieldType::eFloat32 :
+        return sizeof(float);
+
+        case FieldType::eUInt64 :
+        return sizeof(uint64_t);
+
+        case FieldType::eInt32 :
+        return sizeof(int);
+
+        default:
+        return sizeof(bool);
+    }
+}
+
+const std::vector<Field>& stateFields()
+{
+    static const std::vector<Field> fields = []()
+    {
+        static const ClientNetworkConfig::AlliedState s {};
+        std::vector<Field> f;
+        FieldBuilder<ClientNetworkConfig::AlliedState> b(s, f);
+
+        b.add("state.torso.pos", s.state.torso.pos);
+        b.add("state.torso.vel", s.state.torso.vel);
+        b.add("state.torso.timestamp", s.state.torso.timestamp);
+
+        b.add("state.joint.pos", s.state.joint.pos);
+        b.add("state.joint.vel", s.state.joint.vel);
+        b.add("state.joint.tor", s.state.joint.tor);
+        b.add("state.joint.kp", s.state.joint.kp);
+        b.add("state.joint.kd", s.state.joint.kd);
+        b.add("state.joint.timestamp", s.state.joint.timestamp);
+
+        b.add("state.imu.acc", s.state.imu.acc);
+        b.add("state.imu.gyro", s.state.imu.gyro);
+        b.add("state.imu.mag", s.state.imu.mag);
+        b.add("state.imu.euler", s.state.imu.euler);
+        b.add("state.imu.timestamp", s.state.imu.timestamp);
+
+        b.add("state.power.voltage", s.state.power.voltage);
+        b.add("state.power.current", s.state.power.current);
+
+        addConfig_(b, s.config);
+        return f;
+    }();
+
+    return fields;
+}
+
+const std::vector<Field>& planFields()
+{
+    static const std::vector<Field> fields = []()
+    {
+        static const ClientNetworkConfig::AlliedPlan p {};
+        std::vector<Field> f;
+        FieldBuilder<ClientNetworkConfig::AlliedPlan> b(p, f);
+
+        b.add("plan.torso.pos", p.plan.torso.pos);
+        b.add("plan.torso.vel", p.plan.torso.vel);
+        b.add("plan.torso.timestamp", p.plan.torso.timestamp);
+
+        b.add("plan.joint.pos", p.plan.joint.pos);
+        b.add("plan.joint.vel", p.plan.joint.vel);
+        b.add("plan.joint.tor", p.plan.joint.tor);
+        b.add("plan.joint.kp", p.plan.joint.kp);
+        b.add("plan.joint.kd", p.plan.joint.kd);
+        b.add("plan.joint.timestamp", p.plan.joint.timestamp);
+
+        addConfig_(b, p.config);
+        return f;
+    }();
+
+    return fields;
+}
+
+};
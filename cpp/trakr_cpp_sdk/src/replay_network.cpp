@@ -0,0 +1,279 @@
+#include "replay_network.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace FlightLog
+{
+
+ReplayNetwork::ReplayNetwork(const std::string &path, ReplayMode mode)
+    : path_(path), mode_(mode)
+{
+}
+
+/**
+ * @brief Open the log and read ahead the first state
+ *
+ */
+bool ReplayNetwork::setup()
+{
+    if(!reader_.open(path_))
+    {
+        std::cout << "[REPLAY] Unable to open log " << path_ << std::endl;
+        return false;
+    }
+
+    has_lookahead_ = false;
+    if(!fetch_())
+    {
+        std::cout << "[REPLAY] No state recorded in " << path_ << std::endl;
+        return false;
+    }
+
+    stats_ = ReplayStats();
+    finished_ = false;
+    return true;
+}
+
+/**
+ * @brief Start the replay clock
+ *
+ */
+bool ReplayNetwork::connect(const char* ip_addr, const int port)
+{
+    (void)ip_addr;
+    (void)port;
+
+    if(!has_next_)
+    {
+        return false;
+    }
+
+    first_stamp_ = next_.stamp;
+    start_ = now();
+    connected_ = true;
+    return true;
+}
+
+bool ReplayNetwork::disconnect()
+{
+    connected_ = false;
+    return true;
+}
+
+bool ReplayNetwork::isConnected()
+{
+    return connected_ && !finished_;
+}
+
+bool ReplayNetwork::shutdown()
+{
+    connected_ = false;
+    return true;
+}
+
+/**
+ * @brief Deliver the next state; in eRealTime, only once it is due
+ *
+ */
+bool ReplayNetwork::readData()
+{
+    if(!connected_ || !has_next_)
+    {
+        return false;
+    }
+
+    if(mode_ == ReplayMode::eRealTime)
+    {
+        // stamps of another session are not comparable : pace from here
+        if((stats_.states > 0) && discontinuous_())
+        {
+            first_stamp_ = next_.stamp;
+            start_ = now();
+            stats_.rebased++;
+        }
+
+        const uint64_t elapsed = now() - start_;
+        if(next_.stamp - first_stamp_ > elapsed)
+        {
+            return false;
+        }
+
+        // hand over the latest due state, as a socket would
+        deliver_();
+        while(has_next_ && !discontinuous_() && (next_.stamp - first_stamp_ <= elapsed))
+        {
+            stats_.skipped++;
+            deliver_();
+        }
+    }
+    else
+    {
+        deliver_();
+    }
+
+    stats_.states++;
+
+    if(capture_ != nullptr)
+    {
+        capture_->recordState(state_, state_stamp_);
+    }
+
+    return true;
+}
+
+bool ReplayNetwork::getData(ClientNetworkConfig::AlliedState &recv_data)
+{
+    if(stats_.states == 0)
+    {
+        return false;
+    }
+
+    recv_data = state_;
+    return true;
+}
+
+bool ReplayNetwork::setData(const ClientNetworkConfig::AlliedPlan &send_data)
+{
+    plan_ = send_data;
+    return true;
+}
+
+/**
+ * @brief Capture the plan produced for the last delivered state
+ *
+ */
+bool ReplayNetwork::writeData()
+{
+    if(!connected_)
+    {
+        return false;
+    }
+
+    stats_.plans++;
+
+    if(capture_ != nullptr)
+    {
+        capture_->recordPlan(plan_, state_stamp_);
+    }
+
+    if(has_recorded_plan_)
+    {
+        compare_();
+        has_recorded_plan_ = false;
+    }
+
+    if(!has_next_)
+    {
+        finished_ = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read ahead the next recorded state, and the first plan recorded after it
+ *
+ */
+bool ReplayNetwork::fetch_()
+{
+    has_next_ = false;
+    has_next_plan_ = false;
+
+    while(has_lookahead_ || reader_.next(lookahead_))
+    {
+        has_lookahead_ = false;
+        if(lookahead_.type == RecordType::eState)
+        {
+            next_ = lookahead_;
+            has_next_ = true;
+            break;
+        }
+    }
+
+    if(!has_next_)
+    {
+        return false;
+    }
+
+    while(reader_.next(lookahead_))
+    {
+        if(lookahead_.type == RecordType::eState)
+        {
+            has_lookahead_ = true;
+            break;
+        }
+
+        if((lookahead_.type == RecordType::ePlan) && !has_next_plan_)
+        {
+            next_plan_ = lookahead_;
+            has_next_plan_ = true;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Make the read-ahead state the current one
+ *
+ */
+void ReplayNetwork::deliver_()
+{
+    state_ = next_.state;
+    state_stamp_ = next_.stamp;
+    recorded_plan_ = next_plan_.plan;
+    has_recorded_plan_ = has_next_plan_;
+
+    fetch_();
+}
+
+/**
+ * @brief Whether the read-ahead state does not follow the delivered one :
+ * its stamp goes backwards or jumps by more than REPLAY_MAX_GAP
+ *
+ */
+bool ReplayNetwork::discontinuous_() const
+{
+    return (next_.stamp < state_stamp_) || (next_.stamp - state_stamp_ > REPLAY_MAX_GAP);
+}
+
+/**
+ * @brief Compare the produced plan against the recorded one
+ *
+ */
+void ReplayNetwork::compare_()
+{
+    const SocketDataTypes::Plan &a = plan_.plan;
+    const SocketDataTypes::Plan &b = recorded_plan_.plan;
+
+    double diff = 0;
+    for(int i = 0; i < NDOF; i++)
+    {
+        diff = std::fmax(diff, std::fabs(a.joint.pos[i] - b.joint.pos[i]));
+        diff = std::fmax(diff, std::fabs(a.joint.vel[i] - b.joint.vel[i]));
+        diff = std::fmax(diff, std::fabs(a.joint.tor[i] - b.joint.tor[i]));
+        diff = std::fmax(diff, std::fabs(a.joint.kp[i] - b.joint.kp[i]));
+        diff = std::fmax(diff, std::fabs(a.joint.kd[i] - b.joint.kd[i]));
+    }
+    for(int i = 0; i < 6; i++)
+    {
+        diff = std::fmax(diff, std::fabs(a.torso.pos[i] - b.torso.pos[i]));
+        diff = std::fmax(diff, std::fabs(a.torso.vel[i] - b.torso.vel[i]));
+    }
+
+    bool config_differs = (plan_.config.status != recorded_plan_.config.status)
+        || (plan_.config.motion.planner != recorded_plan_.config.motion.planner)
+        || (plan_.config.motion.sequence.type != recorded_plan_.config.motion.sequence.type)
+        || (plan_.config.motion.strategy.type != recorded_plan_.config.motion.strategy.type)
+        || (plan_.config.motion.strategy.seq != recorded_plan_.config.motion.strategy.seq);
+
+    stats_.compared++;
+    stats_.max_abs_diff = std::fmax(stats_.max_abs_diff, diff);
+    if(config_differs || (diff > tolerance_))
+    {
+        stats_.mismatched++;
+    }
+}
+
+};
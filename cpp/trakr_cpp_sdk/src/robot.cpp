@@ -6,9 +6,9 @@
  */
 bool Robot::setup(QuadDataTypes::CONFIG_SET &config, AlliedDataTypes::Plan &plan)
 {
-    if(!net_.setup())
+    if(!net_->setup())
     {
-        std::cout << "[ROBOT] Failed to setup Network" << std::endl;
+        TRAKR_LOG_ERROR("[ROBOT] Failed to setup Network");
         return false;
     }
 
@@ -16,21 +16,29 @@ bool Robot::setup(QuadDataTypes::CONFIG_SET &config, AlliedDataTypes::Plan &plan
     dataAdaptor_(plan_, plan);
     plan_.config.status = 0;
 
-    if(!net_.setData(plan_))
+    if(!net_->setData(plan_))
     {
-        std::cout << "[ROBOT] Failed to set data" << std::endl;
+        TRAKR_LOG_ERROR("[ROBOT] Failed to set data");
         return false;
     }
 
-    if(!net_.connect(ip_addr_, port_))
+    if(!net_->connect(ip_addr_, port_))
     {
-        std::cout << "[ROBOT] Failed to connect to Network" << std::endl;
+        TRAKR_LOG_ERROR("[ROBOT] Failed to connect to Network");
+        if(metrics_ != nullptr)
+        {
+            metrics_->handshakes_failed.inc();
+        }
         return false;
     }
 
-    std::cout << "[ROBOT] Connected!" << std::endl;
+    TRAKR_LOG_INFO("[ROBOT] Connected!");
 
-    bringUp_();
+    const bool up = bringUp_();
+    if(metrics_ != nullptr)
+    {
+        (up ? metrics_->handshakes_ok : metrics_->handshakes_failed).inc();
+    }
 
     return true;
 }
@@ -41,18 +49,88 @@ bool Robot::setup(QuadDataTypes::CONFIG_SET &config, AlliedDataTypes::Plan &plan
  */
 bool Robot::run()
 {
-    if(!net_.isConnected())
+    TRAKR_TRACE_SCOPE("Robot::run");
+
+    if(metrics_ == nullptr)
+    {
+        return exchange_();
+    }
+
+    const uint64_t start = Metrics::now();
+    if(metrics_->last_cycle != 0)
     {
-        std::cout << "[ROBOT] Socket disconnected" << std::endl;
+        const double period = (start - metrics_->last_cycle) * 1e-9;
+        metrics_->cycle_period.observe(period);
+        if(period > metrics_->deadline)
+        {
+            metrics_->deadline_misses.inc();
+        }
+    }
+    metrics_->last_cycle = start;
+
+    const bool ok = exchange_();
+
+    metrics_->cycles.inc();
+    if(!ok)
+    {
+        metrics_->failures.inc();
+    }
+    metrics_->connected.set(net_->isConnected() ? 1.0 : 0.0);
+    metrics_->cycle_time.observe((Metrics::now() - start) * 1e-9);
+
+    return ok;
+}
+
+/**
+ * @brief One exchange : read the latest state, then send the plan
+ *
+ */
+bool Robot::exchange_()
+{
+    if(!net_->isConnected())
+    {
+        TRAKR_LOG_ERROR("[ROBOT] Socket disconnected");
         return false;
     }
 
-    if(net_.readData())
+    bool fresh;
+    {
+        TRAKR_TRACE_SCOPE("net.readData");
+        fresh = net_->readData();
+    }
+
+    if(fresh)
     {
-        if(!net_.getData(state_))
         {
-            std::cout << "[ROBOT] Unable to get data from Network" << std::endl;
-            return false;
+            TRAKR_TRACE_SCOPE("net.getData");
+            if(!net_->getData(state_))
+            {
+                TRAKR_LOG_ERROR("[ROBOT] Unable to get data from Network");
+                return false;
+            }
+        }
+
+        if((recorder_ != nullptr) || (shared_ != nullptr) || (metrics_ != nullptr))
+        {
+            // one receive stamp for the recorder, the shared segment and the metrics
+            const uint64_t stamp = SystemClock::monotonic();
+            if(recorder_ != nullptr)
+            {
+                recorder_->recordState(state_, stamp);
+            }
+            if(shared_ != nullptr)
+            {
+                shared_->publish(state_, stamp);
+            }
+            if(metrics_ != nullptr)
+            {
+                if(metrics_->last_state != 0)
+                {
+                    metrics_->state_interval.observe((stamp - metrics_->last_state) * 1e-9);
+                }
+                metrics_->last_state = stamp;
+                metrics_->packets_received.inc();
+            }
         }
 
         // Reset once acknowledged by server
@@ -65,6 +143,16 @@ bool Robot::run()
             }
             config_status_ = state_.config.status;
             state_.config.status = 0;
+
+            // 1 only acknowledges the request; 2 applied, 3 rejected
+            if((metrics_ != nullptr) && (config_status_ == 2))
+            {
+                metrics_->configs_accepted.inc();
+            }
+            else if((metrics_ != nullptr) && (config_status_ == 3))
+            {
+                metrics_->configs_rejected.inc();
+            }
         }
         else
         {
@@ -75,16 +163,29 @@ bool Robot::run()
         }
     }
 
-    if(!net_.setData(plan_))
     {
-        std::cout << "[ROBOT] Unable to set data to network" << std::endl;
-        return false;
+        TRAKR_TRACE_SCOPE("net.writeData");
+        if(!net_->setData(plan_))
+        {
+            TRAKR_LOG_ERROR("[ROBOT] Unable to set data to network");
+            return false;
+        }
+
+        if(!net_->writeData())
+        {
+            TRAKR_LOG_ERROR("[ROBOT] Failed to send data");
+            return false;
+        }
     }
 
-    if(!net_.writeData())
+    if(metrics_ != nullptr)
     {
-        std::cout << "[ROBOT] Failed to send data" << std::endl;
-        return false;
+        metrics_->packets_sent.inc();
+    }
+
+    if(recorder_ != nullptr)
+    {
+        recorder_->recordPlan(plan_, FlightLog::now());
     }
 
     return true;
@@ -96,7 +197,9 @@ bool Robot::run()
  */
 bool Robot::bringUp_()
 {
-    std::cout << "[ROBOT] Waiting for Robot to BringUp!" << std::endl;
+    TRAKR_TRACE_SCOPE("Robot::bringUp");
+
+    TRAKR_LOG_INFO("[ROBOT] Waiting for Robot to BringUp!");
 
     state_.config.status = -1;
 
@@ -110,14 +213,14 @@ bool Robot::bringUp_()
 
         if(!run())
         {
-            std::cout << "[ROBOT] Failed in BringUp" << std::endl;
+            TRAKR_LOG_ERROR("[ROBOT] Failed in BringUp");
             return false;
         }
 
         if(ctr < 100)
         {
             getConfigStatus();
-            usleep(1000);
+            clock_->sleep(1000000);
             continue;
         }
 
@@ -132,7 +235,7 @@ bool Robot::bringUp_()
         {
             plan_.config.status = 0;
         }
-        usleep(1000);
+        clock_->sleep(1000000);
     }
 
     getConfigStatus();
@@ -140,7 +243,7 @@ bool Robot::bringUp_()
 
     setMode_(config);
 
-    std::cout << "[ROBOT] Robot BringUp Completed!" << std::endl;
+    TRAKR_LOG_INFO("[ROBOT] Robot BringUp Completed!");
     return true;
 }
 
@@ -150,9 +253,11 @@ bool Robot::bringUp_()
  */
 bool Robot::setMode_(QuadDataTypes::CONFIG_SET &config)
 {
+    TRAKR_TRACE_SCOPE("Robot::setMode");
+
     if(mode_ != LOW_LEVEL)
     {
-        usleep(1000000);
+        clock_->sleep(1000000000);
         return true;
     }
 
@@ -165,14 +270,14 @@ bool Robot::setMode_(QuadDataTypes::CONFIG_SET &config)
 
         if(!run())
         {
-            std::cout << "[ROBOT] Failed in SetMode" << std::endl;
+            TRAKR_LOG_ERROR("[ROBOT] Failed in SetMode");
             return false;
         }
 
         getConfigStatus();
         getConfig(config);
 
-        usleep(1000);
+        clock_->sleep(1000000);
     }
 
     // Setting config for low-level mode
@@ -180,7 +285,7 @@ bool Robot::setMode_(QuadDataTypes::CONFIG_SET &config)
     {
         if(!run())
         {
-            std::cout << "[ROBOT] Failed in SetMode" << std::endl;
+            TRAKR_LOG_ERROR("[ROBOT] Failed in SetMode");
             return false;
         }
 
@@ -194,7 +299,7 @@ bool Robot::setMode_(QuadDataTypes::CONFIG_SET &config)
         config.motion.strategy.type = MotionModes::eDeveloperMode;
         setConfig(config);
 
-        usleep(1000);
+        clock_->sleep(1000000);
     }
 
     // a fixed blocking delay where robot is performing initial transitions
@@ -206,17 +311,17 @@ bool Robot::setMode_(QuadDataTypes::CONFIG_SET &config)
 
         if(!run())
         {
-            std::cout << "[ROBOT] Failed in SetMode" << std::endl;
+            TRAKR_LOG_ERROR("[ROBOT] Failed in SetMode");
             return false;
         }
 
         getConfigStatus();
         getConfig(config);
 
-        usleep(1000);
+        clock_->sleep(1000000);
     }
 
-    std::cout << "[ROBOT] Switched to LowLevel/Developer Mode" << std::endl;
+    TRAKR_LOG_INFO("[ROBOT] Switched to LowLevel/Developer Mode");
 
     return true;
 }
@@ -227,6 +332,7 @@ bool Robot::setMode_(QuadDataTypes::CONFIG_SET &config)
  */
 bool Robot::setData(AlliedDataTypes::Plan &plan)
 {
+    TRAKR_TRACE_SCOPE("Robot::setData");
     dataAdaptor_(plan_, plan);
     return true;
 }
@@ -237,6 +343,7 @@ bool Robot::setData(AlliedDataTypes::Plan &plan)
  */
 bool Robot::getData(AlliedDataTypes::State &state)
 {
+    TRAKR_TRACE_SCOPE("Robot::getData");
     dataAdaptor_(state_, state);
     return true;
 }
@@ -247,6 +354,7 @@ bool Robot::getData(AlliedDataTypes::State &state)
  */
 bool Robot::setConfig(QuadDataTypes::CONFIG_SET &config)
 {
+    TRAKR_TRACE_SCOPE("Robot::setConfig");
     dataAdaptor_(plan_, config);
     if(plan_.config.status >= 0)
     {
@@ -261,6 +369,7 @@ bool Robot::setConfig(QuadDataTypes::CONFIG_SET &config)
  */
 bool Robot::getConfig(QuadDataTypes::CONFIG_SET &config)
 {
+    TRAKR_TRACE_SCOPE("Robot::getConfig");
     dataAdaptor_(state_, config);
     return true;
 }
@@ -0,0 +1,285 @@
+#include "robot_runner.h"
+
+#include <cstring>
+
+#include <errno.h>
+#include <sys/eventfd.h>
+
+/**
+ * @brief Bring the robot up (blocking), then start exchanging with it
+ * from the thread
+ *
+ */
+bool RobotRunner::start(QuadDataTypes::CONFIG_SET &config, AlliedDataTypes::Plan &plan)
+{
+    if(running_.load())
+    {
+        TRAKR_LOG_WARN("[RUNNER] Already running");
+        return false;
+    }
+
+    if(!robot_.setup(config, plan))
+    {
+        return false;
+    }
+
+    // also the plan sent while no slot of the mux is live, until setData()
+    plan_local_ = plan;
+    plan_.write(plan);
+    robot_.getConfig(config_local_);
+    config_.write(config_local_);
+
+    cycles_ = 0;
+    overruns_ = 0;
+    running_.store(true);
+    alive_.store(true);
+    thread_ = std::thread(&RobotRunner::loop_, this);
+    return true;
+}
+
+/**
+ * @brief Stop and join the thread; the robot stays connected until
+ * destructed
+ *
+ */
+void RobotRunner::stop()
+{
+    running_.store(false);
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+    alive_.store(false);
+}
+
+/**
+ * @brief Plan to be sent from the next cycle on
+ *
+ */
+void RobotRunner::setData(const AlliedDataTypes::Plan &plan)
+{
+    plan_.write(plan);
+}
+
+/**
+ * @brief Latest state received
+ * @return true if it was not read before
+ */
+bool RobotRunner::getData(AlliedDataTypes::State &state)
+{
+    return state_.read(state);
+}
+
+/**
+ * @brief Latest state received, packed as an observation
+ * @param out Observation::SIZE values
+ * @return true if it was not read before
+ */
+bool RobotRunner::getObservation(float* out)
+{
+    const bool fresh = state_.update();
+    Observation::pack(state_.front(), out);
+    return fresh;
+}
+
+/**
+ * @brief Keep the observations of the last length cycles (0 disables);
+ * allocates, so only before start()
+ *
+ */
+bool RobotRunner::setHistory(size_t length)
+{
+    if(running_.load())
+    {
+        TRAKR_LOG_WARN("[RUNNER] History can only be set before start()");
+        return false;
+    }
+    history_.reset(length);
+    return true;
+}
+
+/**
+ * @brief Non-blocking eventfd, counting the cycles run since it was last
+ * read, so that an event loop (select, epoll, asyncio) can wait for new
+ * states and configuration answers; only before start()
+ * @return the descriptor, owned by the runner, or -1
+ */
+int RobotRunner::openNotifyFd()
+{
+    if(notify_fd_ >= 0)
+    {
+        return notify_fd_;
+    }
+    if(running_.load())
+    {
+        TRAKR_LOG_WARN("[RUNNER] Notifications can only be enabled before start()");
+        return -1;
+    }
+
+    notify_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(notify_fd_ < 0)
+    {
+        TRAKR_LOG_ERROR("[RUNNER] Failed to create an eventfd (%s)", strerror(errno));
+    }
+    return notify_fd_;
+}
+
+/**
+ * @brief Publish every state received into the shared-memory segment
+ * /dev/shm/<name>, for local processes (SharedState::Reader); only
+ * before start()
+ *
+ */
+bool RobotRunner::publishState(const std::string &name)
+{
+    if(running_.load())
+    {
+        TRAKR_LOG_WARN("[RUNNER] The state can only be published before start()");
+        return false;
+    }
+
+    std::unique_ptr<SharedState::Publisher> shared(new SharedState::Publisher(name));
+    if(!shared->open())
+    {
+        return false;
+    }
+    robot_.setSharedState(shared.get());
+    shared_ = std::move(shared);
+    return true;
+}
+
+/**
+ * @brief Resolve the mux every cycle and send its winner; while no slot
+ * is live, the plan of setData() is sent instead. Only before start()
+ *
+ */
+bool RobotRunner::setCommandMux(CommandMux *mux)
+{
+    if(running_.load())
+    {
+        TRAKR_LOG_WARN("[RUNNER] The command mux can only be set before start()");
+        return false;
+    }
+    mux_ = mux;
+    return true;
+}
+
+/**
+ * @brief Configuration to be sent on the next cycle
+ * @return its ticket (see configTicket())
+ */
+uint64_t RobotRunner::setConfig(const QuadDataTypes::CONFIG_SET &config)
+{
+    ConfigRequest &request = config_request_.back();
+    request.config = config;
+    request.ticket = ++config_tickets_;
+    config_request_.publish();
+    return request.ticket;
+}
+
+/**
+ * @brief Latest configuration reported by the robot
+ *
+ */
+void RobotRunner::getConfig(QuadDataTypes::CONFIG_SET &config)
+{
+    config_.read(config);
+}
+
+/**
+ * @brief Robot's answer to the last configuration (2 accepted, 3 rejected),
+ * 0 once read
+ *
+ */
+int RobotRunner::getConfigStatus()
+{
+    return config_status_.exchange(0);
+}
+
+/**
+ * @brief Exchange at rate_ until stopped or disconnected, sleeping to the
+ * absolute deadlines of the robot's clock; a late cycle is counted and the
+ * loop resynchronises
+ *
+ */
+void RobotRunner::loop_()
+{
+    ClockSource &clock = robot_.clock();
+    const uint64_t period_ns = (rate_ > 0.0) ? static_cast<uint64_t>(1e9 / rate_) : 1000000;
+    uint64_t next = clock.now() + period_ns;
+
+    while(running_.load(std::memory_order_relaxed))
+    {
+        clock.sleepUntil(next);
+
+        if(!robot_.run())
+        {
+            break;
+        }
+
+        robot_.getData(state_.back());
+        history_.push(state_.back());
+        state_.publish();
+        robot_.getConfig(config_.back());
+        config_.publish();
+
+        const int status = robot_.getConfigStatus();
+        if(status != 0)
+        {
+            config_status_.store(status);
+        }
+
+        if(config_request_.update())
+        {
+            config_local_ = config_request_.front().config;
+            config_status_.store(0);
+            robot_.setConfig(config_local_);
+            config_ticket_.store(config_request_.front().ticket, std::memory_order_release);
+        }
+
+        const bool fresh = plan_.update();
+        if(mux_ != nullptr)
+        {
+            if(mux_->resolve(plan_local_) < 0)
+            {
+                plan_local_ = plan_.front();
+            }
+            robot_.setData(plan_local_);
+        }
+        else if(fresh)
+        {
+            plan_local_ = plan_.front();
+            robot_.setData(plan_local_);
+        }
+
+        cycles_.fetch_add(1, std::memory_order_relaxed);
+
+        notify_();
+
+        next += period_ns;
+        const uint64_t done = clock.now();
+        if(done >= next)
+        {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            next = done + period_ns;
+        }
+    }
+
+    // wake the waiters, so that they see the disconnection
+    alive_.store(false);
+    notify_();
+}
+
+/**
+ * @brief Signal the eventfd, if opened; never blocks
+ *
+ */
+void RobotRunner::notify_()
+{
+    if(notify_fd_ >= 0)
+    {
+        const uint64_t one = 1;
+        ssize_t ret = write(notify_fd_, &one, sizeof(one));
+        (void)ret;
+    }
+}
@@ -0,0 +1,273 @@
+#include "shared_command.h"
+#include "shared_state.h"
+#include "flight_recorder.h"
+#include "logger.h"
+
+#include <cstring>
+#include <new>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SharedCommand
+{
+
+static constexpr size_t SIZE = RECORD_OFFSET + sizeof(Record);
+
+Server::Server(const std::string &name) : name_(SharedState::segmentName(name))
+{
+}
+
+Server::~Server()
+{
+    if(map_ != nullptr)
+    {
+        header_->server.store(0);
+        munmap(map_, SIZE);
+        shm_unlink(name_.c_str());
+    }
+}
+
+/**
+ * @brief Size the segment and write its header; the record left by a
+ * previous server is kept, so that its controller carries on
+ *
+ */
+bool Server::open()
+{
+    if(map_ != nullptr)
+    {
+        return true;
+    }
+
+    int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+    if(fd < 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to open %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    const bool fresh = (fstat(fd, &info) == 0) && (static_cast<size_t>(info.st_size) != SIZE);
+    if(ftruncate(fd, SIZE) != 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to size %s (%s)", name_.c_str(), strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to map %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+    map_ = static_cast<unsigned char*>(map);
+    header_ = reinterpret_cast<Header*>(map_);
+
+    const Header expected;
+    if(fresh || (std::memcmp(header_->magic, expected.magic, sizeof(expected.magic)) != 0)
+        || (header_->version != VERSION) || (header_->record_size != sizeof(Record)))
+    {
+        header_ = new (map_) Header();
+        new (map_ + RECORD_OFFSET) Record();
+    }
+    seq_ = header_->seq.load(std::memory_order_acquire);
+    config_ticket_ = reinterpret_cast<const Record*>(map_ + RECORD_OFFSET)->config_ticket;
+    header_->server.store(getpid());
+
+    TRAKR_LOG_INFO("[SHARED] Taking commands on %s", name_.c_str());
+    return true;
+}
+
+/**
+ * @brief One attempt at a sequence-locked copy; a controller that dies
+ * mid-write cannot stall the caller
+ *
+ */
+bool Server::read(Record &record)
+{
+    if(header_ == nullptr)
+    {
+        return false;
+    }
+
+    const uint64_t begin = header_->seq.load(std::memory_order_acquire);
+    if((begin == seq_) || (begin & 1))
+    {
+        return false;
+    }
+
+    std::memcpy(static_cast<void*>(&record), map_ + RECORD_OFFSET, sizeof(Record));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(header_->seq.load(std::memory_order_relaxed) != begin)
+    {
+        return false;
+    }
+    seq_ = begin;
+    return true;
+}
+
+void Server::answer(uint64_t ticket, int status)
+{
+    if(header_ != nullptr)
+    {
+        header_->answer.store(ticket * 16 + (static_cast<uint64_t>(status) & 15), std::memory_order_release);
+    }
+}
+
+pid_t Server::controller() const
+{
+    return (header_ != nullptr) ? static_cast<pid_t>(header_->controller.load()) : 0;
+}
+
+Controller::Controller(const std::string &name) : name_(SharedState::segmentName(name))
+{
+}
+
+Controller::~Controller()
+{
+    close();
+}
+
+/**
+ * @brief Map the segment and lock it; tickets carry on from the record
+ * left by the previous controller
+ *
+ */
+bool Controller::open()
+{
+    if(map_ != nullptr)
+    {
+        return true;
+    }
+
+    fd_ = shm_open(name_.c_str(), O_RDWR, 0);
+    if(fd_ < 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] No segment %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if((fstat(fd_, &info) != 0) || (static_cast<size_t>(info.st_size) != SIZE))
+    {
+        TRAKR_LOG_ERROR("[SHARED] Segment %s is not a trakr command segment of this build", name_.c_str());
+        close();
+        return false;
+    }
+
+    if(flock(fd_, LOCK_EX | LOCK_NB) != 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Segment %s already has a controller", name_.c_str());
+        close();
+        return false;
+    }
+
+    void* map = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if(map == MAP_FAILED)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to map %s (%s)", name_.c_str(), strerror(errno));
+        close();
+        return false;
+    }
+    map_ = static_cast<unsigned char*>(map);
+    header_ = reinterpret_cast<Header*>(map_);
+
+    const Header expected;
+    if((std::memcmp(header_->magic, expected.magic, sizeof(expected.magic)) != 0)
+        || (header_->version != VERSION) || (header_->record_size != sizeof(Record)))
+    {
+        TRAKR_LOG_ERROR("[SHARED] Segment %s is not a trakr command segment of this build", name_.c_str());
+        close();
+        return false;
+    }
+
+    // a previous controller may have died mid-write : no one else writes, as we hold the lock
+    const uint64_t seq = header_->seq.load(std::memory_order_relaxed);
+    if(seq & 1)
+    {
+        header_->seq.store(seq + 1, std::memory_order_release);
+    }
+    std::memcpy(static_cast<void*>(&record_), map_ + RECORD_OFFSET, sizeof(Record));
+    header_->controller.store(getpid());
+    return true;
+}
+
+/**
+ * @brief Unmap and release the lock, leaving the last record in place
+ *
+ */
+void Controller::close()
+{
+    if(map_ != nullptr)
+    {
+        header_->controller.store(0);
+        munmap(map_, SIZE);
+        map_ = nullptr;
+        header_ = nullptr;
+    }
+    if(fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool Controller::isAlive() const
+{
+    return (header_ != nullptr) && (header_->server.load(std::memory_order_relaxed) != 0);
+}
+
+void Controller::setData(const AlliedDataTypes::Plan &plan)
+{
+    record_.plan = plan;
+    write_();
+}
+
+uint64_t Controller::setConfig(const QuadDataTypes::CONFIG_SET &config)
+{
+    record_.config = config;
+    record_.config_ticket++;
+    write_();
+    return record_.config_ticket;
+}
+
+int Controller::configStatus(uint64_t ticket) const
+{
+    if(header_ == nullptr)
+    {
+        return 0;
+    }
+    const uint64_t answer = header_->answer.load(std::memory_order_acquire);
+    return ((answer / 16) == ticket) ? static_cast<int>(answer % 16) : 0;
+}
+
+/**
+ * @brief Sequence-locked copy of the record
+ *
+ */
+void Controller::write_()
+{
+    if(header_ == nullptr)
+    {
+        return;
+    }
+
+    record_.stamp = FlightLog::now();
+
+    const uint64_t seq = header_->seq.load(std::memory_order_relaxed);
+    header_->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(map_ + RECORD_OFFSET, static_cast<const void*>(&record_), sizeof(Record));
+
+    header_->seq.store(seq + 2, std::memory_order_release);
+}
+
+};
@@ -0,0 +1,241 @@
+#include "shared_state.h"
+#include "logger.h"
+
+#include <cstring>
+#include <new>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SharedState
+{
+
+static size_t aligned_(size_t size)
+{
+    return (size + 63) & ~static_cast<size_t>(63);
+}
+
+std::string segmentName(const std::string &name)
+{
+    return (!name.empty() && (name[0] == '/')) ? name : "/" + name;
+}
+
+Publisher::Publisher(const std::string &name) : name_(segmentName(name))
+{
+}
+
+Publisher::~Publisher()
+{
+    if(map_ != nullptr)
+    {
+        munmap(map_, size_);
+        shm_unlink(name_.c_str());
+    }
+}
+
+/**
+ * @brief Size the segment and write its header and field table; a
+ * segment left by a previous publisher is taken over, so that its
+ * readers carry on
+ *
+ */
+bool Publisher::open()
+{
+    if(map_ != nullptr)
+    {
+        return true;
+    }
+
+    const std::vector<PacketFields::Field> &fields = PacketFields::stateFields();
+    const size_t record_offset = aligned_(sizeof(Header) + fields.size() * sizeof(FieldEntry));
+    size_ = record_offset + sizeof(uint64_t) + sizeof(ClientNetworkConfig::AlliedState);
+
+    int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+    if(fd < 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to open %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+    if(ftruncate(fd, size_) != 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to size %s (%s)", name_.c_str(), strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to map %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+    map_ = static_cast<unsigned char*>(map);
+
+    header_ = new (map_) Header();
+    header_->field_count = fields.size();
+    header_->record_offset = record_offset;
+    header_->packet_size = sizeof(ClientNetworkConfig::AlliedState);
+
+    FieldEntry* entries = reinterpret_cast<FieldEntry*>(map_ + sizeof(Header));
+    for(size_t i = 0; i < fields.size(); i++)
+    {
+        FieldEntry entry;
+        std::strncpy(entry.name, fields[i].name.c_str(), sizeof(entry.name) - 1);
+        entry.type = static_cast<uint32_t>(fields[i].type);
+        entry.offset = fields[i].offset;
+        entries[i] = entry;
+    }
+
+    record_ = map_ + record_offset;
+    TRAKR_LOG_INFO("[SHARED] Publishing the state on %s", name_.c_str());
+    return true;
+}
+
+/**
+ * @brief Sequence-locked copy of the packet; no allocation, no syscalls
+ *
+ */
+void Publisher::publish(const ClientNetworkConfig::AlliedState &state, uint64_t stamp)
+{
+    if(header_ == nullptr)
+    {
+        return;
+    }
+
+    const uint64_t seq = header_->seq.load(std::memory_order_relaxed);
+    header_->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(record_, &stamp, sizeof(stamp));
+    std::memcpy(record_ + sizeof(stamp), &state, sizeof(state));
+
+    header_->seq.store(seq + 2, std::memory_order_release);
+}
+
+Reader::Reader(const std::string &name) : name_(segmentName(name))
+{
+}
+
+Reader::~Reader()
+{
+    if(map_ != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(map_), size_);
+    }
+}
+
+/**
+ * @brief Map the segment read-only and check its header
+ *
+ */
+bool Reader::open()
+{
+    if(map_ != nullptr)
+    {
+        return true;
+    }
+
+    int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+    if(fd < 0)
+    {
+        TRAKR_LOG_ERROR("[SHARED] No segment %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if((fstat(fd, &info) != 0) || (static_cast<size_t>(info.st_size) < sizeof(Header)))
+    {
+        TRAKR_LOG_ERROR("[SHARED] Segment %s is not initialised", name_.c_str());
+        close(fd);
+        return false;
+    }
+    size_ = info.st_size;
+
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        TRAKR_LOG_ERROR("[SHARED] Failed to map %s (%s)", name_.c_str(), strerror(errno));
+        return false;
+    }
+    map_ = static_cast<const unsigned char*>(map);
+    header_ = reinterpret_cast<const Header*>(map_);
+
+    const Header expected;
+    if((std::memcmp(header_->magic, expected.magic, sizeof(expected.magic)) != 0)
+        || (header_->version != VERSION)
+        || (header_->record_offset + sizeof(uint64_t) + header_->packet_size > size_))
+    {
+        TRAKR_LOG_ERROR("[SHARED] Segment %s is not a trakr state segment", name_.c_str());
+        munmap(map, size_);
+        map_ = nullptr;
+        header_ = nullptr;
+        return false;
+    }
+
+    packet_size_ = header_->packet_size;
+    record_ = map_ + header_->record_offset;
+    scratch_.assign(packet_size_, 0);
+
+    const FieldEntry* entries = reinterpret_cast<const FieldEntry*>(map_ + sizeof(Header));
+    fields_.clear();
+    for(uint32_t i = 0; i < header_->field_count; i++)
+    {
+        fields_.push_back({std::string(entries[i].name, strnlen(entries[i].name, sizeof(entries[i].name))),
+                           static_cast<PacketFields::FieldType>(entries[i].type), entries[i].offset});
+    }
+    return true;
+}
+
+/**
+ * @brief Seqlock read into the scratch record, given up after READ_ATTEMPTS
+ * so that a publisher that died mid-write never stalls the reader; the
+ * packet is only written once the sequence has checked out
+ *
+ */
+uint64_t Reader::read(void* packet, uint64_t* stamp) const
+{
+    if(header_ == nullptr)
+    {
+        return 0;
+    }
+
+    uint64_t copied_stamp;
+    for(int attempt = 0; attempt < READ_ATTEMPTS; attempt++)
+    {
+        const uint64_t begin = header_->seq.load(std::memory_order_acquire);
+        if(begin == 0)
+        {
+            return 0;
+        }
+        if(begin & 1)
+        {
+            continue;
+        }
+
+        std::memcpy(&copied_stamp, record_, sizeof(copied_stamp));
+        std::memcpy(scratch_.data(), record_ + sizeof(copied_stamp), packet_size_);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(header_->seq.load(std::memory_order_relaxed) == begin)
+        {
+            std::memcpy(packet, scratch_.data(), packet_size_);
+            if(stamp != nullptr)
+            {
+                *stamp = copied_stamp;
+            }
+            return begin / 2;
+        }
+    }
+    return 0;
+}
+
+uint64_t Reader::count() const
+{
+    return (header_ != nullptr) ? header_->seq.load(std::memory_order_acquire) / 2 : 0;
+}
+
+};
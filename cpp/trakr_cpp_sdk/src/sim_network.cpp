@@ -0,0 +1,235 @@
+#include "sim_network.h"
+#include "motion_configs.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Sim
+{
+
+static constexpr double GRAVITY = 9.81;
+
+SimNetwork::SimNetwork(const SimParams &params) : params_(params)
+{
+}
+
+bool SimNetwork::lowLevel() const
+{
+    return (state_.config.motion.planner == static_cast<int>(MotionDataTypes::TaskTypes::eMotion))
+        && (state_.config.motion.strategy.type == static_cast<int>(MotionModes::eDeveloperMode));
+}
+
+bool SimNetwork::setup()
+{
+    return params_.step > 0.0;
+}
+
+/**
+ * @brief Stand still at the origin, configured as the plan set before
+ * connecting
+ *
+ */
+bool SimNetwork::connect(const char* ip_addr, const int port)
+{
+    (void)ip_addr;
+    (void)port;
+
+    q_ = params_.stance;
+    dq_.fill(0.0);
+    tau_.fill(0.0);
+    x_ = y_ = yaw_ = 0.0;
+    vx_ = vy_ = wz_ = 0.0;
+    ax_ = ay_ = 0.0;
+
+    state_ = ClientNetworkConfig::AlliedState();
+    state_.config = plan_.config;
+    answer_ = 0;
+    answered_ = false;
+
+    fill_();
+    fresh_ = true;
+    connected_ = true;
+    return true;
+}
+
+bool SimNetwork::disconnect()
+{
+    connected_ = false;
+    return true;
+}
+
+bool SimNetwork::isConnected()
+{
+    return connected_;
+}
+
+bool SimNetwork::shutdown()
+{
+    connected_ = false;
+    return true;
+}
+
+bool SimNetwork::readData()
+{
+    const bool fresh = fresh_;
+    fresh_ = false;
+    return fresh;
+}
+
+bool SimNetwork::getData(ClientNetworkConfig::AlliedState &recv_data)
+{
+    recv_data = state_;
+    return true;
+}
+
+bool SimNetwork::setData(const ClientNetworkConfig::AlliedPlan &send_data)
+{
+    plan_ = send_data;
+    return true;
+}
+
+bool SimNetwork::writeData()
+{
+    if(!connected_)
+    {
+        return false;
+    }
+
+    configure_();
+
+    for(int i = 0; i < std::max(params_.substeps, 1); i++)
+    {
+        step_();
+    }
+
+    clock_.advance(static_cast<uint64_t>(params_.step * 1e9));
+    steps_++;
+
+    fill_();
+    fresh_ = true;
+    return true;
+}
+
+/**
+ * @brief Accept a configuration request once, answering it with the next
+ * state
+ *
+ */
+void SimNetwork::configure_()
+{
+    if(plan_.config.status != 1)
+    {
+        answered_ = false;
+        return;
+    }
+    if(answered_)
+    {
+        return;
+    }
+
+    state_.config = plan_.config;
+    answer_ = 2;
+    answered_ = true;
+}
+
+/**
+ * @brief One substep : joint PD dynamics (semi-implicit Euler), then the
+ * torso following its command with a first-order lag
+ *
+ */
+void SimNetwork::step_()
+{
+    const double dt = params_.step / std::max(params_.substeps, 1);
+    const bool low_level = lowLevel();
+    const bool killed = state_.config.master.killed;
+
+    for(int i = 0; i < NDOF; i++)
+    {
+        const SocketDataTypes::JointState &cmd = plan_.plan.joint;
+        // killed : limp, friction only
+        double tau = 0.0;
+        if(!killed && low_level)
+        {
+            tau = cmd.kp[i] * (cmd.pos[i] - q_[i]) + cmd.kd[i] * (cmd.vel[i] - dq_[i]) + cmd.tor[i];
+        }
+        else if(!killed)
+        {
+            tau = params_.stance_kp * (params_.stance[i] - q_[i]) - params_.stance_kd * dq_[i];
+        }
+        tau = std::max(-params_.tor_limit, std::min(params_.tor_limit, tau));
+
+        dq_[i] += (tau - params_.damping * dq_[i]) / params_.inertia * dt;
+        q_[i] += dq_[i] * dt;
+        tau_[i] = tau;
+    }
+
+    // the torso walks in high level mode only, on the motion planner
+    double cmd_vx = 0.0, cmd_vy = 0.0, cmd_wz = 0.0;
+    if(!low_level && !killed
+        && (state_.config.motion.planner == static_cast<int>(MotionDataTypes::TaskTypes::eMotion)))
+    {
+        cmd_wz = plan_.plan.torso.vel[2];
+        cmd_vx = plan_.plan.torso.vel[3];
+        cmd_vy = plan_.plan.torso.vel[4];
+    }
+
+    const double gain = (params_.torso_lag > 0.0) ? std::min(dt / params_.torso_lag, 1.0) : 1.0;
+    const double dvx = (cmd_vx - vx_) * gain;
+    const double dvy = (cmd_vy - vy_) * gain;
+    vx_ += dvx;
+    vy_ += dvy;
+    wz_ += (cmd_wz - wz_) * gain;
+
+    // acceleration in the torso frame, centripetal terms included
+    ax_ = dvx / dt - wz_ * vy_;
+    ay_ = dvy / dt + wz_ * vx_;
+
+    yaw_ += wz_ * dt;
+    x_ += (vx_ * std::cos(yaw_) - vy_ * std::sin(yaw_)) * dt;
+    y_ += (vx_ * std::sin(yaw_) + vy_ * std::cos(yaw_)) * dt;
+}
+
+/**
+ * @brief Write the simulated robot into the state packet
+ *
+ */
+void SimNetwork::fill_()
+{
+    const uint64_t now = clock_.now();
+    SocketDataTypes::State &state = state_.state;
+    const bool low_level = lowLevel();
+
+    for(int i = 0; i < NDOF; i++)
+    {
+        state.joint.pos[i] = static_cast<float>(q_[i]);
+        state.joint.vel[i] = static_cast<float>(dq_[i]);
+        state.joint.tor[i] = static_cast<float>(tau_[i]);
+        state.joint.kp[i] = static_cast<float>(low_level ? plan_.plan.joint.kp[i] : params_.stance_kp);
+        state.joint.kd[i] = static_cast<float>(low_level ? plan_.plan.joint.kd[i] : params_.stance_kd);
+    }
+    state.joint.timestamp = now;
+
+    state.torso.pos = {0.0f, 0.0f, static_cast<float>(yaw_), static_cast<float>(x_), static_cast<float>(y_),
+                       static_cast<float>(params_.height)};
+    state.torso.vel = {0.0f, 0.0f, static_cast<float>(wz_), static_cast<float>(vx_), static_cast<float>(vy_), 0.0f};
+    state.torso.timestamp = now;
+
+    state.imu.acc = {static_cast<float>(ax_), static_cast<float>(ay_), static_cast<float>(GRAVITY)};
+    state.imu.gyro = {0.0f, 0.0f, static_cast<float>(wz_)};
+    state.imu.mag = {static_cast<float>(0.25 * std::cos(yaw_)), static_cast<float>(-0.25 * std::sin(yaw_)), -0.4f};
+    state.imu.euler = {0.0f, 0.0f, static_cast<float>(yaw_)};
+    state.imu.timestamp = now;
+
+    double power = 0.0;
+    for(int i = 0; i < NDOF; i++)
+    {
+        power += std::fabs(tau_[i] * dq_[i]);
+    }
+    state.power.voltage = 48.0f;
+    state.power.current = static_cast<float>(0.5 + power / 48.0);
+
+    state_.config.status = answer_;
+    answer_ = 0;
+}
+
+};
@@ -0,0 +1,205 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace Trace
+{
+
+std::atomic<bool> enabled_ {false};
+
+/**
+ * @brief Ring of events written by one thread only
+ *
+ */
+struct ThreadBuffer
+{
+    explicit ThreadBuffer(size_t capacity) : events(capacity)
+    {
+    }
+
+    std::vector<Event> events;
+
+    /// @brief events ever written; slot is head % capacity
+    std::atomic<uint64_t> head {0};
+
+    /// @brief events before this index were cleared
+    std::atomic<uint64_t> cleared {0};
+
+    int tid = 0;
+
+    std::string name;
+};
+
+/// @brief every thread that recorded, kept after the thread exits
+static std::mutex registry_mutex_;
+static std::vector<std::shared_ptr<ThreadBuffer>> registry_;
+static size_t buffer_size_ = 1 << 16;
+
+static thread_local ThreadBuffer* buffer_ = nullptr;
+static thread_local std::string thread_name_;
+
+static ThreadBuffer* threadBuffer_()
+{
+    if(buffer_ == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>(std::max<size_t>(buffer_size_, 1));
+        buffer->tid = static_cast<int>(syscall(SYS_gettid));
+        buffer->name = thread_name_;
+        registry_.push_back(buffer);
+        buffer_ = buffer.get();
+    }
+    return buffer_;
+}
+
+void enable(bool on)
+{
+    enabled_.store(on, std::memory_order_relaxed);
+}
+
+void setBufferSize(size_t events)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    buffer_size_ = events;
+}
+
+void setThreadName(const std::string &name)
+{
+    thread_name_ = name;
+    if(buffer_ != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        buffer_->name = name;
+    }
+}
+
+/**
+ * @brief Store the event in the thread's ring, then publish it
+ *
+ */
+void record(const char* name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer* buffer = threadBuffer_();
+
+    const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[head % buffer->events.size()];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Copy the events of a ring still being written
+ *
+ */
+static void snapshot_(const ThreadBuffer &buffer, std::vector<Event> &events)
+{
+    const uint64_t capacity = buffer.events.size();
+    const uint64_t head = buffer.head.load(std::memory_order_acquire);
+    const uint64_t first = std::max((head > capacity) ? head - capacity : 0,
+                                    buffer.cleared.load(std::memory_order_relaxed));
+
+    events.clear();
+    for(uint64_t i = first; i < head; i++)
+    {
+        events.push_back(buffer.events[i % capacity]);
+    }
+
+    // slots reused by the writer during the copy are dropped
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = buffer.head.load(std::memory_order_relaxed);
+    const uint64_t valid = (after > capacity) ? after - capacity : 0;
+    if(valid > first)
+    {
+        events.erase(events.begin(), events.begin() + std::min<uint64_t>(valid - first, events.size()));
+    }
+}
+
+static void writeEscaped_(FILE* file, const std::string &text)
+{
+    for(char c : text)
+    {
+        if((c == '"') || (c == '\\'))
+        {
+            fputc('\\', file);
+        }
+        if(static_cast<unsigned char>(c) >= 0x20)
+        {
+            fputc(c, file);
+        }
+    }
+}
+
+/**
+ * @brief Chrome trace-event format : one complete ("X") event per scope
+ *
+ */
+bool writeChrome(const std::string &path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if(file == nullptr)
+    {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        buffers = registry_;
+    }
+
+    const int pid = static_cast<int>(getpid());
+    bool first = true;
+    std::vector<Event> events;
+
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for(const std::shared_ptr<ThreadBuffer> &buffer : buffers)
+    {
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            name = buffer->name;
+        }
+
+        if(!name.empty())
+        {
+            fprintf(file, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": %d, \"tid\": %d, \"args\": {\"name\": \"",
+                    first ? "" : ",\n", pid, buffer->tid);
+            writeEscaped_(file, name);
+            fprintf(file, "\"}}");
+            first = false;
+        }
+
+        snapshot_(*buffer, events);
+        for(const Event &event : events)
+        {
+            fprintf(file, "%s{\"ph\": \"X\", \"name\": \"", first ? "" : ",\n");
+            writeEscaped_(file, event.name);
+            fprintf(file, "\", \"pid\": %d, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                    pid, buffer->tid, event.begin / 1e3, (event.end - event.begin) / 1e3);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = (ferror(file) == 0);
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+void clear()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for(const std::shared_ptr<ThreadBuffer> &buffer : registry_)
+    {
+        buffer->cleared.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+};
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "robot_runner.h"
+#include "shared_command.h"
+
+// Single link with the robot, shared by local processes (see README.md)
+//
+// usage : ./bin/trakr_broker <ip> <port> [--low-level] [--rate <hz>] [--state <name>]
+//                            [--command <name>] [--command-timeout <s>] [--stats <s>]
+//   --low-level       : low level mode, default high level
+//   --rate            : exchange rate, default 1000
+//   --state           : shared-memory segment of the states, default trakr_state
+//   --command         : shared-memory segment of the commands, default trakr_command
+//   --command-timeout : a controller silent for longer is held, default 0.1
+//   --stats           : period of the statistics printed, default 10 (0 : none)
+//
+// The link thread (RobotRunner) exchanges with the robot and copies each
+// state into the state segment; observers (SharedState::Reader, Python
+// trakr_sdk.SharedState) copy it out on their own, so that adding observers
+// costs the link nothing. The main thread relays the commands of the one
+// controller (SharedCommand::Controller) to the link thread, woken after
+// every cycle. A stale controller is held : high level, zero torso velocity;
+// low level, its last position with zero velocity and torque.
+
+static std::atomic<bool> running_ {true};
+
+static void onSignal_(int)
+{
+    running_.store(false);
+}
+
+static void hold_(AlliedDataTypes::Plan &plan, bool low_level)
+{
+    if(low_level)
+    {
+        plan.joint.vel = JointVector::Zero();
+        plan.joint.tor = JointVector::Zero();
+    }
+    else
+    {
+        plan.torso.vel = Vector6::Zero();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string ip;
+    int port = 0;
+    bool low_level = false;
+    double rate = 1000.0;
+    std::string state_name = "trakr_state";
+    std::string command_name = "trakr_command";
+    double command_timeout = 0.1;
+    double stats_period = 10.0;
+
+    bool usage = false;
+    int positional = 0;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if(arg == "--low-level")
+        {
+            low_level = true;
+        }
+        else if((arg == "--rate") && has_value)
+        {
+            rate = std::stod(argv[++i]);
+        }
+        else if((arg == "--state") && has_value)
+        {
+            state_name = argv[++i];
+        }
+        else if((arg == "--command") && has_value)
+        {
+            command_name = argv[++i];
+        }
+        else if((arg == "--command-timeout") && has_value)
+        {
+            command_timeout = std::stod(argv[++i]);
+        }
+        else if((arg == "--stats") && has_value)
+        {
+            stats_period = std::stod(argv[++i]);
+        }
+        else if((arg.compare(0, 2, "--") != 0) && (positional == 0))
+        {
+            ip = arg;
+            positional++;
+        }
+        else if((arg.compare(0, 2, "--") != 0) && (positional == 1))
+        {
+            port = std::stoi(arg);
+            positional++;
+        }
+        else
+        {
+            usage = true;
+        }
+    }
+    if(usage || (positional != 2))
+    {
+        std::cout << "usage : " << argv[0] << " <ip> <port> [--low-level] [--rate <hz>] [--state <name>]"
+                  << " [--command <name>] [--command-timeout <s>] [--stats <s>]" << std::endl;
+        return 1;
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal_;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    RobotRunner runner(ip.c_str(), port, low_level ? LOW_LEVEL : HIGH_LEVEL, rate);
+    SharedCommand::Server commands(command_name);
+
+    const int notify_fd = runner.openNotifyFd();
+    if((notify_fd < 0) || !runner.publishState(state_name) || !commands.open())
+    {
+        return 1;
+    }
+
+    AlliedDataTypes::Plan plan;
+    QuadDataTypes::CONFIG_SET config;
+    if(!runner.start(config, plan))
+    {
+        std::cout << "[BROKER] Failed to bring the robot up" << std::endl;
+        return 1;
+    }
+    std::cout << "[BROKER] Serving " << ip << ":" << port << " on /dev/shm/" << state_name
+              << " (states) and /dev/shm/" << command_name << " (commands)" << std::endl;
+
+    SharedCommand::Record record;
+    uint64_t applied_ticket = commands.configTicket();
+    uint64_t sent_ticket = 0;
+    uint64_t runner_ticket = 0;
+
+    const uint64_t timeout_ns = static_cast<uint64_t>(std::max(command_timeout, 0.0) * 1e9);
+    const uint64_t stats_ns = static_cast<uint64_t>(std::max(stats_period, 0.0) * 1e9);
+    uint64_t last_command = 0;
+    bool held = true;
+    uint64_t relayed = 0, stale = 0, last_cycles = 0, last_overruns = 0;
+    uint64_t next_stats = SystemClock::monotonic() + stats_ns;
+
+    while(running_.load() && runner.isAlive())
+    {
+        struct pollfd pfd = {notify_fd, POLLIN, 0};
+        if(poll(&pfd, 1, 100) > 0)
+        {
+            // drain the count of cycles
+            uint64_t cycles;
+            ssize_t drained = read(notify_fd, &cycles, sizeof(cycles));
+            (void)drained;
+        }
+        const uint64_t now = SystemClock::monotonic();
+
+        if(commands.read(record))
+        {
+            plan = record.plan;
+            runner.setData(plan);
+            last_command = now;
+            held = false;
+            relayed++;
+
+            if(record.config_ticket != applied_ticket)
+            {
+                applied_ticket = record.config_ticket;
+                sent_ticket = applied_ticket;
+                runner_ticket = runner.setConfig(record.config);
+                commands.answer(sent_ticket, 1);
+            }
+        }
+        else if(!held && (now - last_command > timeout_ns))
+        {
+            hold_(plan, low_level);
+            runner.setData(plan);
+            held = true;
+            stale++;
+            std::cout << "[BROKER] Controller silent for " << command_timeout << " s, holding" << std::endl;
+        }
+
+        // a status read once the runner sent the request answers it; 1 is only
+        // the robot's acknowledgement, already answered when relaying
+        if((sent_ticket != 0) && (runner.configTicket() >= runner_ticket))
+        {
+            const int status = runner.getConfigStatus();
+            if(status >= 2)
+            {
+                commands.answer(sent_ticket, status);
+                sent_ticket = 0;
+            }
+        }
+
+        if((stats_ns > 0) && (now >= next_stats))
+        {
+            const uint64_t cycles = runner.cycles();
+            const uint64_t overruns = runner.overruns();
+            std::cout << "[BROKER] cycles " << cycles - last_cycles << ", overruns " << overruns - last_overruns
+                      << ", commands " << relayed << ", stale " << stale
+                      << ", controller " << commands.controller() << std::endl;
+            last_cycles = cycles;
+            last_overruns = overruns;
+            relayed = 0;
+            stale = 0;
+            next_stats = now + stats_ns;
+        }
+    }
+
+    if(!runner.isAlive())
+    {
+        std::cout << "[BROKER] Link with the robot lost" << std::endl;
+    }
+    runner.stop();
+    return running_.load() ? 1 : 0;
+}
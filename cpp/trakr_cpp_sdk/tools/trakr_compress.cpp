@@ -0,0 +1,63 @@
+#include <iostream>
+#include <sys/stat.h>
+
+#include "log_codec.h"
+
+// Converts a flight log into a single compressed .trz file (see README.md)
+//
+// usage : ./bin/trakr_compress <log> <out.trz> [block_records]
+//   <log> : segment file or directory of segments (.trlog or .trz)
+
+static size_t fileSize_(const std::string &path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        std::cout << "usage : " << argv[0] << " <log> <out.trz> [block_records]" << std::endl;
+        return 1;
+    }
+
+    FlightLog::Reader reader;
+    if(!reader.open(argv[1]))
+    {
+        std::cout << "[COMPRESS] Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    LogCodec::Writer writer;
+    uint32_t block_records = (argc > 3) ? std::stoul(argv[3]) : 1024;
+    if(!writer.open(argv[2], block_records, reader.header().wall_ns, reader.header().mono_ns))
+    {
+        std::cout << "[COMPRESS] Failed to create " << argv[2] << std::endl;
+        return 1;
+    }
+
+    size_t records = 0;
+    FlightLog::Entry entry;
+    while(reader.next(entry))
+    {
+        writer.write(entry);
+        records++;
+    }
+    writer.close();
+
+    size_t raw = 0;
+    for(const std::string &segment : reader.segments())
+    {
+        raw += fileSize_(segment);
+    }
+    size_t compressed = fileSize_(argv[2]);
+
+    std::cout << "[COMPRESS] " << records << " records, " << raw << " -> " << compressed << " bytes";
+    if(compressed > 0)
+    {
+        std::cout << " (x" << static_cast<double>(raw) / compressed << ")";
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include <iostream>
+
+#include "column_store.h"
+
+// Converts a flight log into a columnar file (see README.md)
+//
+// usage : ./bin/trakr_export <log> <out.trcol>
+//   <log> : segment file or directory of segments
+
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        std::cout << "usage : " << argv[0] << " <log> <out.trcol>" << std::endl;
+        return 1;
+    }
+
+    if(!ColumnStore::exportLog(argv[1], argv[2]))
+    {
+        std::cout << "[EXPORT] Failed to export " << argv[1] << std::endl;
+        return 1;
+    }
+
+    ColumnStore::Reader reader;
+    if(!reader.open(argv[2]))
+    {
+        return 1;
+    }
+
+    std::cout << "[EXPORT] " << reader.rows() << " rows x " << reader.columns().size() << " columns written to " << argv[2] << std::endl;
+    return 0;
+}
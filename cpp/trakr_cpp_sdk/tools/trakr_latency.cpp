@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "robot.h"
+
+// Closed-loop latency of a Robot client against a local stand-in robot (see README.md)
+//
+// usage : ./bin/trakr_latency [--rate <hz>]... [--duration <s>] [--load <threads>] [--rt]
+//                             [--port <port>] [--json <out.json>]
+//   --rate     : control rate(s) to measure, default 400 and 1000
+//   --duration : measured seconds per rate, default 10
+//   --load     : busy threads competing for the CPU, default 0
+//   --rt       : SCHED_FIFO + mlockall for the client (and stand-in)
+//
+// The stand-in sends AlliedState at the control rate, tagging joint.pos[0]
+// with a sequence number; the client mirrors joint.pos back in its plan.
+//  - turnaround  : state sent -> reply received (socket + SDK receive path)
+//  - closed-loop : state sent -> first plan computed from that state
+
+static bool setRealtime_(int priority)
+{
+    struct sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+/// @brief sequence numbers travel as floats; exact below 2^24
+static constexpr uint32_t SEQ_MASK = (1u << 24) - 1;
+
+struct Stats
+{
+    size_t count = 0;
+    double mean = 0;
+    double stddev = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+};
+
+static Stats stats_(std::vector<uint64_t> &samples)
+{
+    Stats s;
+    s.count = samples.size();
+    if(samples.empty())
+    {
+        return s;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0;
+    for(uint64_t v : samples)
+    {
+        sum += v;
+    }
+    s.mean = sum / samples.size();
+
+    double var = 0;
+    for(uint64_t v : samples)
+    {
+        var += (v - s.mean) * (v - s.mean);
+    }
+    s.stddev = std::sqrt(var / samples.size());
+
+    auto at = [&samples](double q)
+    {
+        return static_cast<double>(samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))]);
+    };
+    s.p50 = at(0.5);
+    s.p99 = at(0.99);
+    s.p999 = at(0.999);
+    s.max = samples.back();
+    return s;
+}
+
+/**
+ * @brief Stand-in robot; streams states and timestamps the replies
+ *
+ */
+class StandIn
+{
+    public:
+
+    StandIn(int port, double rate, bool rt)
+        : port_(port), period_ns_(static_cast<uint64_t>(1e9 / rate)), rt_(rt), sent_(RING)
+    {
+    }
+
+    ~StandIn()
+    {
+        stop();
+    }
+
+    bool start()
+    {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port_);
+        if((bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+            || (listen(listen_fd_, 1) != 0))
+        {
+            std::cout << "[LATENCY] Failed to listen on port " << port_ << " : " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        running_.store(true);
+        sender_ = std::thread(&StandIn::sendLoop_, this);
+        return true;
+    }
+
+    void stop()
+    {
+        running_.store(false);
+        if(sender_.joinable())
+        {
+            sender_.join();
+        }
+        if(receiver_.joinable())
+        {
+            receiver_.join();
+        }
+        if(fd_ >= 0)
+        {
+            close(fd_);
+            fd_ = -1;
+        }
+        if(listen_fd_ >= 0)
+        {
+            close(listen_fd_);
+            listen_fd_ = -1;
+        }
+    }
+
+    /// @brief only states sent from now on are measured
+    void measure(bool on)
+    {
+        first_seq_.store(on ? seq_.load() + 1 : ~0ull);
+    }
+
+    std::vector<uint64_t> turnaround;
+
+    std::vector<uint64_t> closed_loop;
+
+    private:
+
+    static constexpr size_t RING = 1 << 16;
+
+    int port_;
+
+    uint64_t period_ns_;
+
+    bool rt_;
+
+    int listen_fd_ = -1;
+
+    int fd_ = -1;
+
+    std::atomic<bool> running_ {false};
+
+    std::atomic<uint64_t> seq_ {0};
+
+    std::atomic<uint64_t> first_seq_ {~0ull};
+
+    /// @brief send time of each state, by sequence
+    std::vector<std::atomic<uint64_t>> sent_;
+
+    std::thread sender_;
+
+    std::thread receiver_;
+
+    bool accept_()
+    {
+        struct pollfd pfd = {listen_fd_, POLLIN, 0};
+        while(running_.load())
+        {
+            if(poll(&pfd, 1, 100) > 0)
+            {
+                fd_ = accept(listen_fd_, nullptr, nullptr);
+                int one = 1;
+                setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                return fd_ >= 0;
+            }
+        }
+        return false;
+    }
+
+    void sendLoop_()
+    {
+        if(rt_ && !setRealtime_(90))
+        {
+            std::cout << "[LATENCY] Stand-in could not switch to SCHED_FIFO" << std::endl;
+        }
+
+        if(!accept_())
+        {
+            return;
+        }
+        receiver_ = std::thread(&StandIn::receiveLoop_, this);
+
+        ClientNetworkConfig::AlliedState state {};
+        state.config.status = 0;
+
+        uint64_t next = SystemClock::monotonic();
+        while(running_.load(std::memory_order_relaxed))
+        {
+            next += period_ns_;
+            SystemClock::instance().sleepUntil(next);
+
+            uint64_t seq = seq_.load(std::memory_order_relaxed) + 1;
+            state.state.joint.pos[0] = static_cast<float>(seq & SEQ_MASK);
+            state.state.joint.timestamp = SystemClock::monotonic();
+
+            sent_[seq % RING].store(state.state.joint.timestamp, std::memory_order_relaxed);
+            seq_.store(seq, std::memory_order_release);
+
+            const char* p = reinterpret_cast<const char*>(&state);
+            size_t left = sizeof(state);
+            while(left > 0)
+            {
+                ssize_t n = send(fd_, p, left, MSG_NOSIGNAL);
+                if(n <= 0)
+                {
+                    running_.store(false);
+                    return;
+                }
+                p += n;
+                left -= n;
+            }
+        }
+    }
+
+    void receiveLoop_()
+    {
+        if(rt_)
+        {
+            setRealtime_(90);
+        }
+
+        ClientNetworkConfig::AlliedPlan plan;
+        uint64_t replies = 0;
+        uint64_t last = 0;
+
+        while(running_.load(std::memory_order_relaxed))
+        {
+            ssize_t n = recv(fd_, &plan, sizeof(plan), MSG_WAITALL);
+            if(n != static_cast<ssize_t>(sizeof(plan)))
+            {
+                break;
+            }
+
+            const uint64_t now = SystemClock::monotonic();
+            const uint64_t sent = seq_.load(std::memory_order_acquire);
+            const uint64_t first = first_seq_.load(std::memory_order_relaxed);
+
+            // the SDK answers every state with one plan, in order
+            replies++;
+            if((replies >= first) && (replies <= sent))
+            {
+                turnaround.push_back(now - sent_[replies % RING].load(std::memory_order_relaxed));
+            }
+
+            // plans repeat until the client computes a new one
+            uint64_t tag = static_cast<uint64_t>(plan.plan.joint.pos[0]) & SEQ_MASK;
+            uint64_t seq = (sent & ~static_cast<uint64_t>(SEQ_MASK)) | tag;
+            if(seq > sent)
+            {
+                if(seq <= SEQ_MASK)
+                {
+                    continue;
+                }
+                seq -= (SEQ_MASK + 1);
+            }
+            if(seq > last)
+            {
+                if((seq >= first) && (sent - seq < RING))
+                {
+                    closed_loop.push_back(now - sent_[seq % RING].load(std::memory_order_relaxed));
+                }
+                last = seq;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Busy thread competing with the control loop
+ *
+ */
+static void burn_(std::atomic<bool> &running)
+{
+    std::vector<double> buf(1 << 16, 1.0);
+    size_t i = 0;
+    while(running.load(std::memory_order_relaxed))
+    {
+        buf[i & (buf.size() - 1)] = buf[(i * 7) & (buf.size() - 1)] * 1.0000001 + 1e-9;
+        i++;
+    }
+}
+
+static void print_(const char* name, const Stats &s)
+{
+    printf("  %-12s n=%-8zu p50=%9.1f  p99=%9.1f  p99.9=%9.1f  max=%9.1f  jitter=%8.1f us\n",
+           name, s.count, s.p50 / 1e3, s.p99 / 1e3, s.p999 / 1e3, s.max / 1e3, s.stddev / 1e3);
+}
+
+static std::string json_(const Stats &s)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"count\": %zu, \"mean_ns\": %.0f, \"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f, \"jitter_ns\": %.0f}",
+             s.count, s.mean, s.p50, s.p99, s.p999, s.max, s.stddev);
+    return buf;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<double> rates;
+    double duration = 10.0;
+    int load = 0;
+    bool rt = false;
+    int port = 15351;
+    std::string json;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if((arg == "--rate") && has_value)
+        {
+            rates.push_back(std::stod(argv[++i]));
+        }
+        else if((arg == "--duration") && has_value)
+        {
+            duration = std::stod(argv[++i]);
+        }
+        else if((arg == "--load") && has_value)
+        {
+            load = std::stoi(argv[++i]);
+        }
+        else if((arg == "--port") && has_value)
+        {
+            port = std::stoi(argv[++i]);
+        }
+        else if((arg == "--json") && has_value)
+        {
+            json = argv[++i];
+        }
+        else if(arg == "--rt")
+        {
+            rt = true;
+        }
+        else
+        {
+            std::cout << "usage : " << argv[0] << " [--rate <hz>]... [--duration <s>] [--load <threads>] [--rt] [--port <port>] [--json <out.json>]" << std::endl;
+            return 1;
+        }
+    }
+    if(rates.empty())
+    {
+        rates = {400.0, 1000.0};
+    }
+
+    if(rt && (mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+    {
+        std::cout << "[LATENCY] mlockall failed : " << strerror(errno) << std::endl;
+    }
+
+    std::atomic<bool> burning {true};
+    std::vector<std::thread> burners;
+    for(int i = 0; i < load; i++)
+    {
+        burners.emplace_back(burn_, std::ref(burning));
+    }
+
+    std::string results;
+    int status = 0;
+
+    for(double rate : rates)
+    {
+        StandIn standin(port, rate, rt);
+        if(!standin.start())
+        {
+            status = 1;
+            break;
+        }
+
+        Stats turnaround, closed_loop;
+        bool rt_ok = !rt;
+
+        // the control thread, written as a user would
+        std::thread client([&]()
+        {
+            if(rt)
+            {
+                rt_ok = setRealtime_(80);
+            }
+
+            Robot robot("127.0.0.1", port);
+            AlliedDataTypes::Plan plan;
+            AlliedDataTypes::State state;
+            QuadDataTypes::CONFIG_SET config;
+
+            if(!robot.setup(config, plan))
+            {
+                return;
+            }
+
+            const uint64_t period = static_cast<uint64_t>(1e9 / rate);
+            uint64_t next = SystemClock::monotonic();
+            const uint64_t end = next + static_cast<uint64_t>(duration * 1e9);
+
+            standin.measure(true);
+            while(robot.isAlive() && (next < end))
+            {
+                robot.run();
+                robot.getData(state);
+
+                plan.joint.pos = state.joint.pos;
+                robot.setData(plan);
+
+                next += period;
+                SystemClock::instance().sleepUntil(next);
+            }
+            standin.measure(false);
+        });
+        client.join();
+        standin.stop();
+
+        turnaround = stats_(standin.turnaround);
+        closed_loop = stats_(standin.closed_loop);
+
+        printf("[LATENCY] %.0f Hz, %.1f s, load %d, %s\n", rate, duration, load,
+               rt ? (rt_ok ? "SCHED_FIFO" : "SCHED_FIFO requested (denied)") : "SCHED_OTHER");
+        print_("turnaround", turnaround);
+        print_("closed-loop", closed_loop);
+
+        if(closed_loop.count == 0)
+        {
+            status = 1;
+        }
+
+        char head[128];
+        snprintf(head, sizeof(head), "{\"rate_hz\": %.0f, \"duration_s\": %.1f, \"load\": %d, \"rt\": %s, ",
+                 rate, duration, load, (rt && rt_ok) ? "true" : "false");
+        results += std::string(results.empty() ? "" : ",\n") + "  " + head
+            + "\"turnaround\": " + json_(turnaround) + ", \"closed_loop\": " + json_(closed_loop) + "}";
+    }
+
+    burning.store(false);
+    for(std::thread &t : burners)
+    {
+        t.join();
+    }
+
+    if(!json.empty())
+    {
+        std::ofstream out(json);
+        out << "{\"runs\": [\n" << results << "\n]}" << std::endl;
+    }
+
+    return status;
+}
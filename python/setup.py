@@ -13,7 +13,7 @@ setup(
     author_email="humanoid@addverb.com",
     packages=["trakr_sdk"],
     package_data= {
-        "trakr_sdk" : ["lib/amd64/*"], 
+        "trakr_sdk" : ["lib/amd64/*", "lib/*.so"], 
     },
     description="Trakr SDK for Communication over Socket",
     install_requires=[
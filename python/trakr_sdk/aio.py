@@ -0,0 +1,144 @@
+import asyncio
+import os
+
+import numpy as np
+
+from . import config_types as QuadDataTypes
+from . import data_types as AlliedDataTypes
+
+from .data_types import NDOF
+from .robot import Robot, RobotMode
+
+# asyncio client of the robot. The exchange runs in the SDK's thread (see Robot);
+# that thread signals an eventfd after every cycle, watched by the event loop
+# with add_reader(), so coroutines wait for states and configuration answers
+# without a thread of their own, and one event loop can drive several robots.
+#
+#     robot = AsyncRobot(ROBOT_IP, ROBOT_PORT)
+#     await robot.setup(config, plan)
+#     async for state in robot.states():
+#         robot.setData(policy(state))
+#     accepted = await robot.apply_config(config)
+
+# robot's answers to a configuration (getConfigStatus())
+CONFIG_ACCEPTED = 2
+CONFIG_REJECTED = 3
+
+def _newState() -> AlliedDataTypes.State:
+    # AlliedDataTypes.State shares its members between instances; one of its own
+    state = AlliedDataTypes.State()
+    state.joint = AlliedDataTypes.JointState()
+    state.torso = AlliedDataTypes.TorsoState()
+    state.imu = AlliedDataTypes.IMUState()
+    for name in ("pos", "vel", "tor", "kp", "kd"):
+        setattr(state.joint, name, np.zeros(NDOF))
+    state.torso.pos = np.zeros(6)
+    state.torso.vel = np.zeros(6)
+    for name in ("acc", "gyro", "mag", "euler"):
+        setattr(state.imu, name, np.zeros(3))
+    return state
+
+class AsyncRobot:
+    def __init__(self, ip : str, port : int, mode : int = RobotMode.eHighLevel, rate : float = 1000.0, history : int = 0):
+        self.robot = Robot(ip, port, mode, rate, history)
+
+        self.fd_ : int = self.robot.runner_.openNotifyFd()
+        if(self.fd_ < 0):
+            raise OSError("[ROBOT] Failed to open the notification eventfd")
+
+        self.loop_ = None
+        self.tick_ = None
+        self.pending_ = None
+        self.pendingTicket_ : int = 0
+        # created in setup(), on the running loop (a lock binds to a loop on Python 3.8)
+        self.configLock_ = None
+
+    # connection and bring-up run in the default executor (the GIL is released meanwhile)
+    async def setup(self, config : QuadDataTypes.CONFIG_SET, plan : AlliedDataTypes.Plan) -> bool:
+        self.loop_ = asyncio.get_running_loop()
+        self.tick_ = self.loop_.create_future()
+        self.configLock_ = asyncio.Lock()
+
+        if(not await self.loop_.run_in_executor(None, self.robot.setup, config, plan)):
+            return False
+
+        self.loop_.add_reader(self.fd_, self._onNotify)
+        return True
+
+    def stop(self):
+        self.robot.stop()
+        if(self.loop_ is not None):
+            self._onNotify()
+
+    def isAlive(self) -> bool:
+        return self.robot.isAlive()
+
+    # waits for the next cycle of the exchange; False once the robot is gone
+    async def wait(self) -> bool:
+        self._checkSetup("wait")
+        if(not self.robot.isAlive()):
+            return False
+        # shielded, as the future is shared by every waiter
+        await asyncio.shield(self.tick_)
+        return self.robot.isAlive()
+
+    # latest state after every cycle (several cycles may be coalesced if the
+    # consumer is slower); the yielded state is refilled on the next iteration
+    async def states(self, state : AlliedDataTypes.State = None):
+        self._checkSetup("states")
+        if(state is None):
+            state = _newState()
+        while(await self.wait()):
+            self.robot.getData(state)
+            yield state
+
+    # sends the configuration, and resolves with the robot's answer : True if
+    # accepted, False if rejected; raises asyncio.TimeoutError without answer.
+    # Configurations are applied one at a time, in order.
+    async def apply_config(self, config : QuadDataTypes.CONFIG_SET, timeout : float = 5.0) -> bool:
+        self._checkSetup("apply_config")
+        async with self.configLock_:
+            self.pending_ = self.loop_.create_future()
+            try:
+                self.robot.setConfig(config)
+                self.pendingTicket_ = self.robot.configTicket_
+                status = await asyncio.wait_for(asyncio.shield(self.pending_), timeout)
+            finally:
+                self.pending_ = None
+            return (status == CONFIG_ACCEPTED)
+
+    def setData(self, plan : AlliedDataTypes.Plan) -> bool:
+        return self.robot.setData(plan)
+
+    def getData(self, state : AlliedDataTypes.State) -> bool:
+        return self.robot.getData(state)
+
+    def getConfig(self, config : QuadDataTypes.CONFIG_SET) -> bool:
+        return self.robot.getConfig(config)
+
+    def _checkSetup(self, name : str):
+        if(self.loop_ is None):
+            raise RuntimeError("[ROBOT] AsyncRobot." + name + "() needs setup() to be awaited first")
+
+    def _onNotify(self):
+        try:
+            os.read(self.fd_, 8)
+        except BlockingIOError:
+            pass
+
+        # only an answer read once the configuration was sent belongs to it
+        if((self.pending_ is not None) and (not self.pending_.done())
+           and (self.robot.runner_.configTicket() >= self.pendingTicket_)):
+            # 1 only acknowledges the request : keep waiting for 2 or 3
+            status = self.robot.getConfigStatus()
+            if(status >= CONFIG_ACCEPTED):
+                self.pending_.set_result(status)
+
+        if(not self.robot.isAlive()):
+            self.loop_.remove_reader(self.fd_)
+            if((self.pending_ is not None) and (not self.pending_.done())):
+                self.pending_.set_exception(ConnectionError("[ROBOT] Robot disconnected"))
+
+        tick = self.tick_
+        self.tick_ = self.loop_.create_future()
+        tick.set_result(None)
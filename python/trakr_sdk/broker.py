@@ -0,0 +1,53 @@
+from .lib import trakr_python_sdk as sdk
+
+from .robot import Robot, QuadDataTypes, AlliedDataTypes
+
+# Controller of a robot held by trakr_broker (see ../cpp/trakr_cpp_sdk/README.md),
+# with the calls of Robot; the states are read by any process with
+# trakr_sdk.shared.SharedState. Only one controller is accepted at a time : the
+# lock is released when this one is closed, or its process exits.
+#
+#     controller = BrokerController("trakr_command")
+#     controller.setData(plan)
+#     ticket = controller.setConfig(config)
+#     status = controller.configStatus(ticket)    # 0 pending, 1 sent, 2 accepted, 3 rejected
+class BrokerController:
+    # packet conversions shared with Robot
+    _setPlanToPacket = Robot._setPlanToPacket
+    _setConfigToPacket = Robot._setConfigToPacket
+
+    def __init__(self, name : str = "trakr_command"):
+        self.controller_ = sdk.SharedCommandController(name)
+        if(not self.controller_.open()):
+            raise RuntimeError("[BROKER] No broker on " + name + ", or it already has a controller")
+
+        self.plan_ = sdk.allied.Plan()
+        self.config_ = sdk.quad.ConfigSet()
+
+        self.planJoint_ = self.plan_.joint
+        self.planJointPos_ = self.planJoint_.pos
+        self.planJointVel_ = self.planJoint_.vel
+        self.planJointTor_ = self.planJoint_.tor
+        self.planJointKp_ = self.planJoint_.kp
+        self.planJointKd_ = self.planJoint_.kd
+        self.planTorsoPos_ = self.plan_.torso.pos
+        self.planTorsoVel_ = self.plan_.torso.vel
+
+    def close(self):
+        self.controller_.close()
+
+    def isAlive(self) -> bool:
+        return self.controller_.isAlive()
+
+    def setData(self, plan : AlliedDataTypes.Plan) -> bool:
+        self._setPlanToPacket(plan)
+        self.controller_.setData(self.plan_)
+        return True
+
+    # returns the ticket of the configuration, for configStatus()
+    def setConfig(self, config : QuadDataTypes.CONFIG_SET) -> int:
+        self._setConfigToPacket(config)
+        return self.controller_.setConfig(self.config_)
+
+    def configStatus(self, ticket : int) -> int:
+        return int(self.controller_.configStatus(ticket))
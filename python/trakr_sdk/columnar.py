@@ -0,0 +1,74 @@
+import mmap
+import struct
+
+import numpy as np
+
+# Reader for column files written by trakr_cpp_sdk (ColumnStore / ./bin/trakr_export).
+# Every column is a numpy view straight into the mapped file, so reading one
+# channel (e.g. "state.joint.tor.7") only pages in that channel.
+
+_HEADER = struct.Struct("<8sIIQQQ")
+_COLUMN = struct.Struct("<56sIIQ")
+_MAGIC = b"TRKRCOL\0"
+_VERSION = 1
+
+_DTYPES = {
+    0 : np.float32,
+    1 : np.uint64,
+    2 : np.int32,
+    3 : np.bool_,
+}
+
+class ColumnFile:
+    def __init__(self, path : str):
+        self._file = open(path, "rb")
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        magic, version, columns, rows, wall_ns, mono_ns = _HEADER.unpack_from(self._map, 0)
+        if((magic != _MAGIC) or (version != _VERSION)):
+            raise ValueError("[COLUMNS] Not a column file " + path)
+
+        self.rows : int = rows
+        self.wall_ns : int = wall_ns
+        self.mono_ns : int = mono_ns
+
+        self._columns = {}
+        for i in range(columns):
+            name, dtype, _, offset = _COLUMN.unpack_from(self._map, _HEADER.size + i * _COLUMN.size)
+            self._columns[name.rstrip(b"\0").decode()] = (_DTYPES[dtype], offset)
+
+    def names(self) -> list:
+        return list(self._columns.keys())
+
+    def column(self, name : str) -> np.ndarray:
+        dtype, offset = self._columns[name]
+        return np.frombuffer(self._map, dtype=dtype, count=self.rows, offset=offset)
+
+    def __getitem__(self, name : str) -> np.ndarray:
+        return self.column(name)
+
+    def lower_bound(self, stamp : int, session : int = 0) -> int:
+        # first row of the session received at or after "stamp" (monotonic ns);
+        # "stamp" is only sorted within a session (they restart after a reboot)
+        begin, end = 0, self.rows
+        if("session" in self._columns):
+            sessions = self.column("session")
+            begin = int(np.searchsorted(sessions, session, side="left"))
+            end = int(np.searchsorted(sessions, session, side="right"))
+        return begin + int(np.searchsorted(self.column("stamp")[begin:end], stamp, side="left"))
+
+    def to_pandas(self, names : list = None):
+        import pandas as pd
+        names = self.names() if names is None else names
+        return pd.DataFrame({name : self.column(name) for name in names}, copy=False)
+
+    def close(self):
+        self._columns = {}
+        self._map.close()
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
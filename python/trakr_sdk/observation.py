@@ -0,0 +1,39 @@
+import numpy as np
+
+from .lib import trakr_python_sdk as sdk
+
+# Observation of the robot's state as one float32 vector, laid out by the C++ SDK
+# (Observation::FIELDS) : joint pos, vel, tor, kp, kd, torso pos, vel, imu acc,
+# gyro, mag and euler. The same memory can be read as a structured array, one
+# named field per quantity, without copying.
+#
+#     obs = observation.empty()               # once
+#     robot.getObservation(obs)               # every step, one copy
+#     observation.fields(obs)["imu.gyro"]     # (3,) view
+#
+#     rows = observation.empty(50)            # with sdk.Robot(..., history=50)
+#     n = robot.getHistory(rows)              # last n states, oldest first
+#     observation.fields(rows[:n])["joint.pos"]   # (n, NDOF) view
+
+SIZE : int = sdk.OBSERVATION_SIZE
+
+# (name, offset, size) in float32 values
+FIELDS = [tuple(field) for field in sdk.OBSERVATION_FIELDS]
+
+DTYPE = np.dtype({
+    "names" : [name for name, _, _ in FIELDS],
+    "formats" : [(np.float32, (size,)) for _, _, size in FIELDS],
+    "offsets" : [offset * 4 for _, offset, _ in FIELDS],
+    "itemsize" : SIZE * 4,
+})
+
+# preallocated observation (SIZE,), or count of them (count, SIZE)
+def empty(count : int = None) -> np.ndarray:
+    if(count is None):
+        return np.zeros(SIZE, dtype=np.float32)
+    return np.zeros((count, SIZE), dtype=np.float32)
+
+# structured view (DTYPE) of an observation, or (N,) view of N of them
+def fields(obs : np.ndarray) -> np.ndarray:
+    records = obs.reshape(-1, SIZE).view(DTYPE)[:, 0]
+    return records[0] if(obs.ndim == 1) else records
@@ -0,0 +1,73 @@
+import re
+
+import numpy as np
+
+from .lib import trakr_python_sdk as sdk
+
+# Reader of the states published in shared memory by the process owning the
+# robot (sdk.Robot(..., shared_state="trakr_state"), or the ROS node with
+# shared_state:=trakr_state). read() copies the latest packet out of the segment
+# under its sequence lock, in microseconds; the channels are numpy views into
+# that copy, so they stay consistent with each other until the next read().
+#
+#     state = SharedState("trakr_state")
+#     while True:
+#         if(state.read()):
+#             pos = state["state.joint.pos"]        # (NDOF,) float32 view
+#             tor7 = state["state.joint.tor.7"]     # () view of one element
+
+# PacketFields::FieldType
+_DTYPES = {
+    0 : np.float32,
+    1 : np.uint64,
+    2 : np.int32,
+    3 : np.bool_,
+}
+
+_ELEMENT = re.compile(r"^(.*)\.(\d+)$")
+
+class SharedState:
+    def __init__(self, name : str = "trakr_state"):
+        self._reader = sdk.SharedStateReader(name)
+        if(not self._reader.open()):
+            raise FileNotFoundError("[SHARED] No state published on " + name)
+
+        self._packet = np.zeros(self._reader.packetSize(), dtype=np.uint8)
+
+        # states published when last read, and their receive stamp (ns, monotonic)
+        self.count : int = 0
+        self.stamp : int = 0
+
+        self._views = {}
+        arrays = {}
+        for name, type, offset in self._reader.fields():
+            dtype = np.dtype(_DTYPES[type])
+            self._views[name] = self._packet[offset:offset + dtype.itemsize].view(dtype).reshape(())
+
+            # elements of an array ("state.joint.pos.3") are contiguous
+            match = _ELEMENT.match(name)
+            if(match is not None):
+                arrays.setdefault(match.group(1), []).append((int(match.group(2)), dtype, offset))
+
+        for name, elements in arrays.items():
+            elements.sort()
+            _, dtype, offset = elements[0]
+            self._views[name] = self._packet[offset:offset + len(elements) * dtype.itemsize].view(dtype)
+
+    # copies the latest state; True if it is newer than the previous read.
+    # False, with count and stamp unchanged, when no consistent copy could be
+    # made (the publisher died or kept writing it)
+    def read(self) -> bool:
+        count, stamp = self._reader.read(self._packet)
+        if(count == 0):
+            return False
+        fresh = (count != self.count)
+        self.count = count
+        self.stamp = stamp
+        return fresh
+
+    def names(self) -> list:
+        return list(self._views.keys())
+
+    def __getitem__(self, name : str) -> np.ndarray:
+        return self._views[name]
@@ -1,38 +1,195 @@
 #ifndef TRAKR_ROS2_NODE_H_
 #define TRAKR_ROS2_NODE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <thread>
 #include <vector>
+#include <cmath>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <Eigen/Geometry>
 #include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
 #include "sensor_msgs/msg/joint_state.hpp"
 #include "sensor_msgs/msg/imu.hpp"
 #include "geometry_msgs/msg/twist.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "nav_msgs/msg/odometry.hpp"
+#include "tf2_ros/transform_broadcaster.h"
+#include "std_msgs/msg/float64_multi_array.hpp"
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
 #include "std_srvs/srv/trigger.hpp"
+#include "trakr_ros2/action/set_mode.hpp"
+#include "trakr_ros2/msg/torso_batch.hpp"
 #include "robot.h"
+#include "triple_buffer.h"
+#include "spsc_queue.h"
 
 class TrakrROS2Node : public rclcpp::Node
 {
 public:
-    TrakrROS2Node() : Node("trakr_ros2") 
+    /// @brief node, also loadable as a component (rclcpp_components)
+    /// @param options node options; with use_intra_process_comms, co-located
+    /// subscribers receive the state without serialization or copies
+    explicit TrakrROS2Node(const rclcpp::NodeOptions &options = rclcpp::NodeOptions())
+    : Node("trakr_ros2", options), intra_process_(options.use_intra_process_comms())
     {
         this->declare_parameter("robot_ip", "127.0.0.1");
         this->declare_parameter("robot_port", 15251);
+        this->declare_parameter("low_level", false);
+        this->declare_parameter("joint_cmd_timeout", 0.05);
+        this->declare_parameter("trace_file", "");
+        this->declare_parameter("metrics_address", "");
+        this->declare_parameter("shared_state", "");
+        this->declare_parameter("exchange_rate", 1000.0);
+        this->declare_parameter("exchange_cpu", -1);
+        this->declare_parameter("exchange_priority", 0);
+        this->declare_parameter("diagnostics_rate", 1.0);
+        this->declare_parameter("jitter_warn_us", 200.0);
+        this->declare_parameter("mode_change_timeout", 5.0);
+        this->declare_parameter("joint_states_rate", 1000.0);
+        this->declare_parameter("imu_rate", 1000.0);
+        this->declare_parameter("body_twist_rate", 1000.0);
+        this->declare_parameter("odom_rate", 200.0);
+        this->declare_parameter("odom_frame", "odom");
+        this->declare_parameter("base_frame", "base_link");
+        this->declare_parameter("publish_tf", true);
+        this->declare_parameter("pose_covariance", std::vector<double>{1e-3, 1e-3, 1e-3, 1e-4, 1e-4, 1e-3});
+        this->declare_parameter("twist_covariance", std::vector<double>{1e-2, 1e-2, 1e-2, 1e-3, 1e-3, 1e-3});
+        this->declare_parameter("odom_batch_size", 0);
 
         setup_();
     };
 
-    ~TrakrROS2Node(){};
+    /// @brief stop the exchange thread, then flush the trace, if tracing
+    ~TrakrROS2Node()
+    {
+        exchanging_.store(false);
+        if(exchange_thread_.joinable())
+        {
+            exchange_thread_.join();
+        }
+
+        if(!trace_file_.empty())
+        {
+            Trace::writeChrome(trace_file_);
+        }
+    };
+
+    /// @brief wait until the exchange with the robot stops : the robot was
+    /// lost (reported on /diagnostics) or ROS was shut down
+    void waitExchange();
 
 private:
+    using SetMode = trakr_ros2::action::SetMode;
+    using GoalHandleSetMode = rclcpp_action::ServerGoalHandle<SetMode>;
+
+    /// @brief configuration requested by a mode change, numbered to match the robot's answer
+    struct ConfigRequest
+    {
+        QuadDataTypes::CONFIG_SET config;
+        uint32_t ticket = 0;
+    };
+
+    /// @brief pending mode change, from the action or from a Trigger service
+    struct ModeChange
+    {
+        uint32_t ticket = 0;
+
+        /// @brief monotonic times (ns)
+        uint64_t start = 0;
+        uint64_t deadline = 0;
+        uint64_t next_feedback = 0;
+
+        /// @brief last status sent as feedback
+        int status = 0;
+
+        /// @brief either the goal, or the service and request to answer
+        std::shared_ptr<GoalHandleSetMode> goal;
+        rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr service;
+        std::shared_ptr<rmw_request_id_t> request_id;
+    };
+
+    /// @brief exchange loop timing over one window (about a second)
+    struct LoopStats
+    {
+        uint64_t cycles = 0;
+        uint64_t overruns = 0;
+        uint64_t total_overruns = 0;
+
+        /// @brief wake-up latency past the deadline (us)
+        double latency_sum = 0.0;
+        double latency_sq_sum = 0.0;
+        double latency_max = 0.0;
+
+        /// @brief largest deviation of a period from the nominal one (us)
+        double jitter_max = 0.0;
+
+        /// @brief cycles holding position for want of a fresh joint command
+        uint64_t stale_commands = 0;
+
+        /// @brief torso states lost to a full batch queue, since start
+        uint64_t dropped_samples = 0;
+    };
+
+    /// @brief torso state of one exchange cycle, for the batched odometry
+    struct TorsoSample
+    {
+        uint64_t stamp;
+        double pos[6];
+        double vel[6];
+    };
+
+    /// @brief joint command of the low-level mode, stamped on reception
+    struct JointCommand
+    {
+        JointVector pos = JointVector::Zero();
+        JointVector vel = JointVector::Zero();
+        JointVector tor = JointVector::Zero();
+        JointVector kp = JointVector::Zero();
+        JointVector kd = JointVector::Zero();
+
+        /// @brief monotonic time (ns) of reception; 0 before the first command
+        uint64_t stamp = 0;
+    };
+
     /// @brief bool indicating if we have connected to robot
-    bool is_connected_ = false;
+    std::atomic<bool> is_connected_ {false};
+
+    /// @brief bool holding if the node publishes intra-process (as an owned message)
+    bool intra_process_ = false;
+
+    /// @brief loop and link metrics of the robot
+    Metrics::Registry metrics_;
+    std::unique_ptr<Metrics::LinkMetrics> link_metrics_;
+
+    /// @brief Prometheus endpoint, if "metrics_address" is set
+    std::unique_ptr<Metrics::HttpExporter> exporter_;
+
+    /// @brief shared-memory segment of the states, if "shared_state" is set
+    std::unique_ptr<SharedState::Publisher> shared_state_;
 
     /// @brief pointer to the low-level sdk/robot/socket
     std::unique_ptr<Robot> trakr_;
 
-    /// @brief timer to run the low-level sdk at steady frequency
-    rclcpp::TimerBase::SharedPtr timer_;
+    /// @brief thread running the low-level sdk at steady frequency, outside the executor
+    std::thread exchange_thread_;
+    std::atomic<bool> exchanging_ {false};
+
+    /// @brief overruns since start, and stale joint commands in the window, exchange thread only
+    uint64_t total_overruns_ = 0;
+    uint64_t stale_commands_ = 0;
+
+    /// @brief timers publishing the latest state, one per publisher
+    std::vector<rclcpp::TimerBase::SharedPtr> publish_timers_;
 
     /// @brief publisher for joint state
     rclcpp::Publisher<sensor_msgs::msg::JointState>::SharedPtr joint_;
@@ -43,34 +200,95 @@ private:
     /// @brief publisher for body twist data in robot-aligned world frame (world frame moving along robot)
     rclcpp::Publisher<geometry_msgs::msg::Twist>::SharedPtr body_twist_;
 
+    /// @brief publisher for odometry (EKF torso pose and twist), and its transform
+    rclcpp::Publisher<nav_msgs::msg::Odometry>::SharedPtr odom_;
+    std::unique_ptr<tf2_ros::TransformBroadcaster> tf_broadcaster_;
+
+    /// @brief publisher for batches of consecutive torso states, if "odom_batch_size" is set
+    rclcpp::Publisher<trakr_ros2::msg::TorsoBatch>::SharedPtr odom_batch_;
+
+    /// @brief publisher of the exchange loop jitter
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diagnostics_;
+
     /// @brief subscriber to listen velocity plan from user
     rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr plan_sub_;
 
+    /// @brief subscriber to joint commands, in low-level mode only
+    rclcpp::Subscription<std_msgs::msg::Float64MultiArray>::SharedPtr joint_cmd_sub_;
+
     /// @brief services for listening for setting various configurations
     std::vector<rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr> srv_;
 
-    /// @brief callback group isolating services from rest
+    /// @brief action switching the robot's configuration
+    rclcpp_action::Server<SetMode>::SharedPtr set_mode_;
+
+    /// @brief timer following the pending mode change, cancelled when there is none
+    rclcpp::TimerBase::SharedPtr mode_timer_;
+
+    /// @brief at most one mode change at a time, in cb_group_service_ only
+    std::optional<ModeChange> mode_change_;
+
+    /// @brief tickets given to the configuration requests, in cb_group_service_ only
+    uint32_t config_tickets_ = 0;
+
+    /// @brief callback group of the services and the mode-change action
     rclcpp::CallbackGroup::SharedPtr cb_group_service_;
 
-    /// @brief callback group isolating wall timer callbacks from rest
-    rclcpp::CallbackGroup::SharedPtr cb_group_timer_;
+    /// @brief callback group of the publishing timers, kept out of the exchange cycle
+    rclcpp::CallbackGroup::SharedPtr cb_group_publish_;
+
+    /// @brief published messages, sized once and refilled every cycle
+    sensor_msgs::msg::JointState joint_msg_;
+    sensor_msgs::msg::Imu imu_msg_;
+    geometry_msgs::msg::Twist body_twist_msg_;
+    nav_msgs::msg::Odometry odom_msg_;
+    geometry_msgs::msg::TransformStamped tf_msg_;
+    trakr_ros2::msg::TorsoBatch batch_msg_;
+
+    /// @brief every torso state of the exchange loop, drained by the batch publisher
+    std::unique_ptr<SpscQueue<TorsoSample>> torso_samples_;
+    size_t odom_batch_size_ = 0;
+
+    /// @brief samples lost to a full queue, exchange thread only
+    uint64_t dropped_samples_ = 0;
 
-    /// @brief data types to store local copies to-and-fro robot
+    /// @brief data types to store local copies to-and-fro robot, exchange thread only
     QuadDataTypes::CONFIG_SET config_;
     AlliedDataTypes::Plan plan_;
     AlliedDataTypes::State state_;
 
-    /// @brief to hold status of configuration received from robot
-    int config_status_ = 0;
+    /// @brief latest state, handed from the exchange loop to the publishers
+    TripleBuffer<AlliedDataTypes::State> snapshot_;
+
+    /// @brief latest configuration of the robot, read by the services
+    TripleBuffer<QuadDataTypes::CONFIG_SET> robot_config_;
+
+    /// @brief configuration requested by a mode change, applied by the exchange loop
+    TripleBuffer<ConfigRequest> config_request_;
+
+    /// @brief ticket of the request last sent to the robot
+    std::atomic<uint32_t> config_ticket_ {0};
+
+    /// @brief latest velocity command, applied by the exchange loop
+    TripleBuffer<geometry_msgs::msg::Twist> cmd_vel_;
+
+    /// @brief latest joint command, applied by the exchange loop while fresh
+    TripleBuffer<JointCommand> joint_cmd_;
 
-    /// @brief bool to hold if a new configuration has to be set in robot
-    bool set_config_ = false;
+    /// @brief age (ns) past which a joint command is no longer applied
+    uint64_t joint_cmd_timeout_ = 0;
 
-    /// @brief mutex only over the configuration
-    std::mutex mut_config_;
+    /// @brief bool to hold if the robot runs in low-level (developer) mode
+    bool low_level_ = false;
 
-    /// @brief mutex only over the user plan
-    std::mutex mut_plan_;
+    /// @brief exchange loop timing, handed over once per window
+    TripleBuffer<LoopStats> loop_stats_;
+
+    /// @brief last answer of the robot to the request config_ticket_ (0 : none yet)
+    std::atomic<int> config_status_ {0};
+
+    /// @brief Chrome trace-event file; tracing is enabled if set
+    std::string trace_file_;
 
     void setup_();
 
@@ -84,35 +302,88 @@ private:
 
     void run_();
 
+    void exchangeLoop_();
+
+    void configureExchangeThread_();
+
+    void sendDiagnostics_();
+
     void planCallback_(const geometry_msgs::msg::Twist::SharedPtr msg);
 
-    void sendState_();
+    void jointCommandCallback_(const std_msgs::msg::Float64MultiArray::SharedPtr msg);
 
-    void waitForResponse_(std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    bool applyJointCommand_(uint64_t now);
 
-    void setAIMode1_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    std::chrono::nanoseconds period_(const std::string &rate_parameter);
 
-    void setAIMode2_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    void createPublishTimer_(const std::string &rate_parameter, std::function<void()> callback);
 
-    void setClassicalMode_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                            std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    const AlliedDataTypes::State& latestState_();
 
-    void setGestureMode_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    void sendJointState_();
 
-    void setGestureStandUp_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
-                    
-    void setGestureSitDown_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    void sendImu_();
 
-    void setGestureLeftHandShake_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                    std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+    void sendBodyTwist_();
+
+    void sendOdometry_();
+
+    void sendOdometryBatch_();
+
+    static void torsoPose_(const double pos[6], Eigen::Vector3d &position, Eigen::Quaterniond &orientation);
 
-    void setGestureRightHandShake_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
+    static void torsoTwist_(const double pos[6], const double vel[6], Eigen::Vector3d &linear, Eigen::Vector3d &angular);
+
+    /// @brief publish an owned copy intra-process, handed to the co-located subscribers
+    /// as is; else through a middleware-loaned message when possible (fixed-size
+    /// messages on a shared-memory capable rmw), else from the preallocated one
+    template <typename MessageT>
+    void publish_(rclcpp::Publisher<MessageT> &publisher, const MessageT &msg)
+    {
+        if(intra_process_)
+        {
+            publisher.publish(std::make_unique<MessageT>(msg));
+            return;
+        }
+
+        if constexpr(rosidl_generator_traits::has_fixed_size<MessageT>::value)
+        {
+            if(publisher.can_loan_messages())
+            {
+                auto loaned = publisher.borrow_loaned_message();
+                loaned.get() = msg;
+                publisher.publish(std::move(loaned));
+                return;
+            }
+        }
+        publisher.publish(msg);
+    }
+
+    void saveTrace_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
                     std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+
+    void createModeService_(const std::string &name, const SetMode::Goal &goal);
+
+    static SetMode::Goal modeGoal_(MotionModes type, MotionGaits seq);
+
+    static SetMode::Goal modeGoal_(GestureTypes type);
+
+    rclcpp_action::GoalResponse handleModeGoal_(const rclcpp_action::GoalUUID &uuid,
+                                                std::shared_ptr<const SetMode::Goal> goal);
+
+    rclcpp_action::CancelResponse handleModeCancel_(const std::shared_ptr<GoalHandleSetMode> goal_handle);
+
+    void handleModeAccepted_(const std::shared_ptr<GoalHandleSetMode> goal_handle);
+
+    void startModeChange_(const SetMode::Goal &goal, ModeChange &change);
+
+    void pollModeChange_();
+
+    void finishModeChange_(bool success, const std::string &message);
+
+    QuadDataTypes::CONFIG_SET& beginConfig_();
+
+    uint32_t commitConfig_();
 };
 
 #endif
\ No newline at end of file
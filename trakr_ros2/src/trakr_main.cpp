@@ -0,0 +1,26 @@
+#include "trakr_node.h"
+
+/**
+ * @brief main code, running the node on its own; see README.md to load it in a
+ * component container instead
+ *
+ */
+int main(int argc, char ** argv)
+{
+    rclcpp::init(argc, argv);
+
+    rclcpp::executors::MultiThreadedExecutor executor;
+
+    std::shared_ptr<TrakrROS2Node> node_ = std::make_shared<TrakrROS2Node>();
+    executor.add_node(node_);
+    std::thread spinner([&executor]() { executor.spin(); });
+
+    // running alone, the process ends with the robot's link (the node only stops its exchange)
+    node_->waitExchange();
+
+    executor.cancel();
+    spinner.join();
+    rclcpp::shutdown();
+
+    return 0;
+}
@@ -6,10 +6,27 @@
  */
 void TrakrROS2Node::setup_()
 {
+    // sdk messages go to the ros2 log (from the sdk's logging thread)
+    Log::setSink([](Log::Level level, const char* line)
+    {
+        static const rclcpp::Logger logger = rclcpp::get_logger("trakr_sdk");
+        switch(level)
+        {
+            case Log::eDebug: RCLCPP_DEBUG(logger, "%s", line); break;
+            case Log::eInfo: RCLCPP_INFO(logger, "%s", line); break;
+            case Log::eWarn: RCLCPP_WARN(logger, "%s", line); break;
+            default: RCLCPP_ERROR(logger, "%s", line); break;
+        }
+    });
+
+    // tracing of the control loop phases, saved on demand and on exit
+    trace_file_ = this->get_parameter("trace_file").as_string();
+    Trace::enable(!trace_file_.empty());
+
     // bringing the robot to life
     setupRobot_();
 
-    // callback groups for services and wall timer
+    // callback groups for services and publishing timers
     createCallbackGroups_();
 
     // creating pub-sub for continuous data streams
@@ -18,12 +35,41 @@ void TrakrROS2Node::setup_()
     // creating services for configurations
     createServices_();
 
-    // creating wall timer running the robot
-    timer_ = this->create_wall_timer(
-        std::chrono::microseconds(1000), 
-        std::bind(&TrakrROS2Node::run_, this),
-        cb_group_timer_
-    );
+    // starting the thread exchanging with the robot
+    exchanging_.store(true);
+    exchange_thread_ = std::thread(&TrakrROS2Node::exchangeLoop_, this);
+
+    // reporting the jitter of the exchange loop
+    std::chrono::nanoseconds diagnostics_period = period_("diagnostics_rate");
+    if(diagnostics_period.count() > 0)
+    {
+        publish_timers_.push_back(this->create_wall_timer(
+            diagnostics_period,
+            std::bind(&TrakrROS2Node::sendDiagnostics_, this),
+            cb_group_publish_
+        ));
+    }
+
+    // creating wall timers publishing the latest state, each at its own rate
+    createPublishTimer_("joint_states_rate", std::bind(&TrakrROS2Node::sendJointState_, this));
+    createPublishTimer_("imu_rate", std::bind(&TrakrROS2Node::sendImu_, this));
+    createPublishTimer_("body_twist_rate", std::bind(&TrakrROS2Node::sendBodyTwist_, this));
+    createPublishTimer_("odom_rate", std::bind(&TrakrROS2Node::sendOdometry_, this));
+
+    // draining the batched torso states about once per batch
+    if(odom_batch_size_ > 0)
+    {
+        std::chrono::nanoseconds sample_period = period_("exchange_rate");
+        if(sample_period.count() == 0)
+        {
+            sample_period = std::chrono::milliseconds(1);
+        }
+        publish_timers_.push_back(this->create_wall_timer(
+            sample_period * odom_batch_size_,
+            std::bind(&TrakrROS2Node::sendOdometryBatch_, this),
+            cb_group_publish_
+        ));
+    }
 
     if(!is_connected_)
     {
@@ -34,6 +80,35 @@ void TrakrROS2Node::setup_()
     RCLCPP_INFO(this->get_logger(), "Node setup completed");
 }
 
+/**
+ * @brief Timer period from a rate parameter (Hz)
+ *
+ */
+std::chrono::nanoseconds TrakrROS2Node::period_(const std::string &rate_parameter)
+{
+    double rate = this->get_parameter(rate_parameter).as_double();
+    if(rate <= 0.0)
+    {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate));
+}
+
+/**
+ * @brief Publishing timer in the publishers' callback group; a rate of 0 disables it
+ *
+ */
+void TrakrROS2Node::createPublishTimer_(const std::string &rate_parameter, std::function<void()> callback)
+{
+    std::chrono::nanoseconds period = period_(rate_parameter);
+    if(period.count() == 0)
+    {
+        RCLCPP_INFO(this->get_logger(), "Publisher disabled (%s = 0)", rate_parameter.c_str());
+        return;
+    }
+    publish_timers_.push_back(this->create_wall_timer(period, callback, cb_group_publish_));
+}
+
 /**
  * @brief Setup the robot (sdk)
  *
@@ -45,8 +120,43 @@ void TrakrROS2Node::setupRobot_()
     int robot_port = this->get_parameter("robot_port").as_int();
     RCLCPP_INFO(this->get_logger(), "Connecting to Trakr at %s:%d", robot_ip.c_str(), robot_port);
 
+    // low-level mode streams joint commands instead of body velocities
+    low_level_ = this->get_parameter("low_level").as_bool();
+    double timeout = this->get_parameter("joint_cmd_timeout").as_double();
+    joint_cmd_timeout_ = static_cast<uint64_t>(std::max(timeout, 0.0) * 1e9);
+
     // creating object for our robot
-    trakr_ = std::make_unique<Robot>(robot_ip.c_str(), robot_port);
+    trakr_ = std::make_unique<Robot>(robot_ip.c_str(), robot_port, low_level_ ? LOW_LEVEL : HIGH_LEVEL);
+
+    // loop and link metrics, served in Prometheus format if an address is given
+    link_metrics_ = std::make_unique<Metrics::LinkMetrics>(
+        metrics_, "robot=\"" + robot_ip + ":" + std::to_string(robot_port) + "\"");
+    trakr_->setMetrics(link_metrics_.get());
+
+    std::string metrics_address = this->get_parameter("metrics_address").as_string();
+    if(!metrics_address.empty())
+    {
+        exporter_ = std::make_unique<Metrics::HttpExporter>(metrics_, metrics_address);
+        if(!exporter_->start())
+        {
+            RCLCPP_WARN(this->get_logger(), "Unable to serve metrics on %s", metrics_address.c_str());
+        }
+    }
+
+    // every state received, shared with local processes through /dev/shm/<shared_state>
+    std::string shared_state = this->get_parameter("shared_state").as_string();
+    if(!shared_state.empty())
+    {
+        shared_state_ = std::make_unique<SharedState::Publisher>(shared_state);
+        if(shared_state_->open())
+        {
+            trakr_->setSharedState(shared_state_.get());
+        }
+        else
+        {
+            RCLCPP_WARN(this->get_logger(), "Unable to publish the state on %s", shared_state.c_str());
+        }
+    }
 
     // setting initial data to zero
     plan_.joint.kp = JointVector::Zero();
@@ -75,9 +185,9 @@ void TrakrROS2Node::setupRobot_()
  */
 void TrakrROS2Node::createCallbackGroups_()
 {
-    // callback groups for services and wall timer
+    // callback groups for services and publishing timers
     cb_group_service_ = this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
-    cb_group_timer_ = this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+    cb_group_publish_ = this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
 }
 
 /**
@@ -90,79 +200,168 @@ void TrakrROS2Node::createDataStreams_()
     joint_ = this->create_publisher<sensor_msgs::msg::JointState>("/trakr/joint_states", 10);
     imu_ = this->create_publisher<sensor_msgs::msg::Imu>("/trakr/imu", 10);
     body_twist_ = this->create_publisher<geometry_msgs::msg::Twist>("/trakr/body_twist", 10);
+    odom_ = this->create_publisher<nav_msgs::msg::Odometry>("/trakr/odom", 10);
+    diagnostics_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>("/diagnostics", 10);
     plan_sub_ = this->create_subscription<geometry_msgs::msg::Twist>(
         "/trakr/cmd_vel", 10, std::bind(&TrakrROS2Node::planCallback_, this, std::placeholders::_1)
     );
+    if(low_level_)
+    {
+        joint_cmd_sub_ = this->create_subscription<std_msgs::msg::Float64MultiArray>(
+            "/trakr/joint_cmd", rclcpp::SensorDataQoS().keep_last(1),
+            std::bind(&TrakrROS2Node::jointCommandCallback_, this, std::placeholders::_1)
+        );
+    }
+
+    // sizing the published messages once, so that publishing never allocates
+    joint_msg_.name = {
+        "FL_adduction", "FL_hip", "FL_thigh",
+        "FR_adduction", "FR_hip", "FR_thigh",
+        "RL_adduction", "RL_hip", "RL_thigh",
+        "RR_adduction", "RR_hip", "RR_thigh",
+    };
+    joint_msg_.position.resize(NDOF);
+    joint_msg_.velocity.resize(NDOF);
+    joint_msg_.effort.resize(NDOF);
+
+    // odometry of the EKF torso estimate, with the configured frames and (diagonal) covariances
+    odom_msg_.header.frame_id = this->get_parameter("odom_frame").as_string();
+    odom_msg_.child_frame_id = this->get_parameter("base_frame").as_string();
+    std::vector<double> pose_covariance = this->get_parameter("pose_covariance").as_double_array();
+    std::vector<double> twist_covariance = this->get_parameter("twist_covariance").as_double_array();
+    for(size_t i = 0; i < 6; i++)
+    {
+        odom_msg_.pose.covariance[7 * i] = (i < pose_covariance.size()) ? pose_covariance[i] : 0.0;
+        odom_msg_.twist.covariance[7 * i] = (i < twist_covariance.size()) ? twist_covariance[i] : 0.0;
+    }
+    if((pose_covariance.size() != 6) || (twist_covariance.size() != 6))
+    {
+        RCLCPP_WARN(this->get_logger(), "pose_covariance and twist_covariance expect 6 values (x, y, z, roll, pitch, yaw)");
+    }
+
+    if(this->get_parameter("publish_tf").as_bool())
+    {
+        tf_broadcaster_ = std::make_unique<tf2_ros::TransformBroadcaster>(*this);
+        tf_msg_.header.frame_id = odom_msg_.header.frame_id;
+        tf_msg_.child_frame_id = odom_msg_.child_frame_id;
+    }
+
+    int batch_size = this->get_parameter("odom_batch_size").as_int();
+    if(batch_size > 0)
+    {
+        odom_batch_size_ = batch_size;
+        odom_batch_ = this->create_publisher<trakr_ros2::msg::TorsoBatch>("/trakr/odom/batch", 10);
+        torso_samples_ = std::make_unique<SpscQueue<TorsoSample>>(std::max<size_t>(4 * odom_batch_size_, 1024));
+
+        batch_msg_.header.frame_id = odom_msg_.header.frame_id;
+        batch_msg_.child_frame_id = odom_msg_.child_frame_id;
+        batch_msg_.stamp.reserve(odom_batch_size_);
+        batch_msg_.pose.reserve(7 * odom_batch_size_);
+        batch_msg_.twist.reserve(6 * odom_batch_size_);
+    }
 }
 
 /**
- * @brief Creating services for different configurations
+ * @brief Creating the mode-change action, and the services for different configurations
  *
  */
 void TrakrROS2Node::createServices_()
 {
-    // creating services for configurations
-    srv_.push_back(
-        this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/ai_mode/walk", 
-            std::bind(&TrakrROS2Node::setAIMode1_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
-            cb_group_service_
-        )
-    );
-    srv_.push_back(
-        this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/ai_mode/climb", 
-            std::bind(&TrakrROS2Node::setAIMode2_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
-            cb_group_service_
-        )
-    );
-    srv_.push_back(
-        this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/classical_mode/trot", 
-            std::bind(&TrakrROS2Node::setClassicalMode_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
-            cb_group_service_
-        )
-    );
-    srv_.push_back(
-        this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/gesture_mode/orientation", 
-            std::bind(&TrakrROS2Node::setGestureMode_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
-            cb_group_service_
-        )
-    );
-    srv_.push_back(
-        this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/gesture_mode/standup", 
-            std::bind(&TrakrROS2Node::setGestureStandUp_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
-            cb_group_service_
-        )
+    // creating the action switching the robot's configuration
+    set_mode_ = rclcpp_action::create_server<SetMode>(
+        this,
+        "/trakr/set_mode",
+        std::bind(&TrakrROS2Node::handleModeGoal_, this, std::placeholders::_1, std::placeholders::_2),
+        std::bind(&TrakrROS2Node::handleModeCancel_, this, std::placeholders::_1),
+        std::bind(&TrakrROS2Node::handleModeAccepted_, this, std::placeholders::_1),
+        rcl_action_server_get_default_options(),
+        cb_group_service_
     );
-    srv_.push_back(
-        this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/gesture_mode/sitdown", 
-            std::bind(&TrakrROS2Node::setGestureSitDown_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
-            cb_group_service_
-        )
+
+    // following the pending change, only while there is one
+    mode_timer_ = this->create_wall_timer(
+        std::chrono::milliseconds(1),
+        std::bind(&TrakrROS2Node::pollModeChange_, this),
+        cb_group_service_
     );
+    mode_timer_->cancel();
+
+    // services for configurations, answered once the robot does (without blocking a thread)
+    createModeService_("/trakr/ai_mode/walk", modeGoal_(MotionModes::eAIMode, MotionGaits::eWalk));
+    createModeService_("/trakr/ai_mode/climb", modeGoal_(MotionModes::eAIMode, MotionGaits::eClimb));
+    createModeService_("/trakr/classical_mode/trot", modeGoal_(MotionModes::eClassicalMode, MotionGaits::eTrot));
+    createModeService_("/trakr/gesture_mode/orientation", modeGoal_(GestureTypes::eOrientation));
+    createModeService_("/trakr/gesture_mode/standup", modeGoal_(GestureTypes::eStandUp));
+    createModeService_("/trakr/gesture_mode/sitdown", modeGoal_(GestureTypes::eSitDown));
+    createModeService_("/trakr/gesture_mode/left_handshake", modeGoal_(GestureTypes::eLeftShakeHand));
+    createModeService_("/trakr/gesture_mode/right_handshake", modeGoal_(GestureTypes::eRightShakeHand));
+
     srv_.push_back(
         this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/gesture_mode/left_handshake", 
-            std::bind(&TrakrROS2Node::setGestureLeftHandShake_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
+            "/trakr/trace/save",
+            std::bind(&TrakrROS2Node::saveTrace_, this, std::placeholders::_1, std::placeholders::_2),
+            rclcpp::ServicesQoS(),
             cb_group_service_
         )
     );
+}
+
+/**
+ * @brief Goal of a motion mode
+ *
+ */
+TrakrROS2Node::SetMode::Goal TrakrROS2Node::modeGoal_(MotionModes type, MotionGaits seq)
+{
+    SetMode::Goal goal;
+    goal.planner = SetMode::Goal::PLANNER_MOTION;
+    goal.strategy_type = static_cast<uint8_t>(type);
+    goal.strategy_seq = static_cast<uint8_t>(seq);
+    return goal;
+}
+
+/**
+ * @brief Goal of a gesture
+ *
+ */
+TrakrROS2Node::SetMode::Goal TrakrROS2Node::modeGoal_(GestureTypes type)
+{
+    SetMode::Goal goal;
+    goal.planner = SetMode::Goal::PLANNER_GESTURE;
+    goal.gesture_type = static_cast<uint8_t>(type);
+    return goal;
+}
+
+/**
+ * @brief Trigger service starting a fixed mode change; the response is sent
+ * by pollModeChange_() when the robot answers
+ *
+ */
+void TrakrROS2Node::createModeService_(const std::string &name, const SetMode::Goal &goal)
+{
+    const size_t index = srv_.size();
     srv_.push_back(
         this->create_service<std_srvs::srv::Trigger>(
-            "/trakr/gesture_mode/right_handshake", 
-            std::bind(&TrakrROS2Node::setGestureRightHandShake_, this, std::placeholders::_1, std::placeholders::_2), 
-            rclcpp::ServicesQoS(), 
+            name,
+            [this, index, goal](const std::shared_ptr<rmw_request_id_t> request_id,
+                                const std::shared_ptr<std_srvs::srv::Trigger::Request> request)
+            {
+                (void)request;
+
+                if(mode_change_.has_value())
+                {
+                    std_srvs::srv::Trigger::Response response;
+                    response.success = false;
+                    response.message = "another mode change is in progress";
+                    srv_[index]->send_response(*request_id, response);
+                    return;
+                }
+
+                ModeChange change;
+                change.service = srv_[index];
+                change.request_id = request_id;
+                startModeChange_(goal, change);
+            },
+            rclcpp::ServicesQoS(),
             cb_group_service_
         )
     );
@@ -174,300 +373,753 @@ void TrakrROS2Node::createServices_()
  */
 void TrakrROS2Node::run_()
 {
+    TRAKR_TRACE_SCOPE("TrakrROS2Node::run");
+
+    // stopping this node's exchange only : the process (or the container) outlives it
     if((!is_connected_) || (!trakr_->run()))
     {
-        RCLCPP_INFO(this->get_logger(), "Failed to run; shutting down network");
-        rclcpp::shutdown();
+        RCLCPP_ERROR(this->get_logger(), "Failed to run; stopping the exchange with the robot");
         is_connected_ = false;
+        exchanging_.store(false);
+        return;
     }
 
     trakr_->getData(state_);
-    mut_config_.lock();
-    if(!set_config_)
+    trakr_->getConfig(config_);
+
+    // handing the state and config over to the ROS callbacks, never waiting on them
+    snapshot_.write(state_);
+    robot_config_.write(config_);
+
+    // every torso state, for the batched odometry
+    if(torso_samples_)
     {
-        trakr_->getConfig(config_);
+        TorsoSample* sample = torso_samples_->beginPush();
+        if(sample != nullptr)
+        {
+            sample->stamp = state_.torso.timestamp;
+            Eigen::Map<Vector6>(sample->pos) = state_.torso.pos;
+            Eigen::Map<Vector6>(sample->vel) = state_.torso.vel;
+            torso_samples_->endPush();
+        }
+        else
+        {
+            dropped_samples_++;
+        }
     }
-    mut_config_.unlock();
-
-    sendState_();
 
-    config_status_ = trakr_->getConfigStatus();
+    // latching the robot's answer (reported once) for the pending mode change
+    int status = trakr_->getConfigStatus();
+    if(status != 0)
+    {
+        config_status_.store(status);
+    }
 
-    mut_config_.lock();
-    if(set_config_)
+    if(config_request_.update())
     {
+        // answers latched so far belong to earlier requests
+        config_status_.store(0);
+        config_ = config_request_.front().config;
         trakr_->setConfig(config_);
-        set_config_ = false;
+        config_ticket_.store(config_request_.front().ticket);
+    }
+
+    if(cmd_vel_.update())
+    {
+        const geometry_msgs::msg::Twist &cmd_vel = cmd_vel_.front();
+        plan_.torso.vel(2) = cmd_vel.angular.z;
+        plan_.torso.vel(3) = cmd_vel.linear.x;
+        plan_.torso.vel(4) = cmd_vel.linear.y;
     }
-    mut_config_.unlock();
 
-    mut_plan_.lock();
+    if(low_level_ && !applyJointCommand_(SystemClock::monotonic()))
+    {
+        stale_commands_++;
+    }
     trakr_->setData(plan_);
-    mut_plan_.unlock();
 }
 
 /**
- * @brief Publishing the states of robot over different topics
+ * @brief Applying the latest joint command, unless it is older than the timeout;
+ * a stale command is replaced by holding its position with zero velocity and torque
  *
  */
-void TrakrROS2Node::sendState_()
+bool TrakrROS2Node::applyJointCommand_(uint64_t now)
 {
-    auto joint = sensor_msgs::msg::JointState();
-    auto imu = sensor_msgs::msg::Imu();
-    auto body_twist = geometry_msgs::msg::Twist();
+    joint_cmd_.update();
+    const JointCommand &cmd = joint_cmd_.front();
 
-    // creating JointState message
-    joint.name = {
-        "FL_adduction", "FL_hip", "FL_thigh",
-        "FR_adduction", "FR_hip", "FR_thigh",
-        "RL_adduction", "RL_hip", "RL_thigh",
-        "RR_adduction", "RR_hip", "RR_thigh",
+    // now may precede a stamp written after it was read
+    if((cmd.stamp != 0) && (cmd.stamp + joint_cmd_timeout_ >= now))
+    {
+        plan_.joint.pos = cmd.pos;
+        plan_.joint.vel = cmd.vel;
+        plan_.joint.tor = cmd.tor;
+        plan_.joint.kp = cmd.kp;
+        plan_.joint.kd = cmd.kd;
+        return true;
+    }
+
+    // never commanded : plan_ keeps the zero gains of the setup
+    if(cmd.stamp != 0)
+    {
+        plan_.joint.pos = cmd.pos;
+        plan_.joint.vel = JointVector::Zero();
+        plan_.joint.tor = JointVector::Zero();
+        plan_.joint.kp = cmd.kp;
+        plan_.joint.kd = cmd.kd;
+    }
+    return false;
+}
+
+/**
+ * @brief Exchange loop on its own thread, woken at absolute deadlines
+ *
+ */
+void TrakrROS2Node::exchangeLoop_()
+{
+    configureExchangeThread_();
+
+    const std::chrono::nanoseconds period = period_("exchange_rate");
+    const uint64_t period_ns = (period.count() > 0) ? period.count() : 1000000;
+    const uint64_t window = std::max<uint64_t>(1, 1000000000ull / period_ns);
+
+    LoopStats stats;
+    uint64_t next = SystemClock::monotonic() + period_ns;
+    uint64_t last_wake = 0;
+
+    while(exchanging_.load(std::memory_order_relaxed) && rclcpp::ok())
+    {
+        SystemClock::instance().sleepUntil(next);
+
+        const uint64_t wake = SystemClock::monotonic();
+        const double latency = (wake - next) * 1e-3;
+        stats.latency_sum += latency;
+        stats.latency_sq_sum += latency * latency;
+        stats.latency_max = std::max(stats.latency_max, latency);
+        if(last_wake != 0)
+        {
+            const double jitter = std::abs(static_cast<double>(wake - last_wake) - period_ns) * 1e-3;
+            stats.jitter_max = std::max(stats.jitter_max, jitter);
+        }
+        last_wake = wake;
+
+        run_();
+        if(!is_connected_)
+        {
+            // the last window, for /diagnostics to report the stop
+            stats.total_overruns = (total_overruns_ += stats.overruns);
+            stats.stale_commands = stale_commands_;
+            stats.dropped_samples = dropped_samples_;
+            loop_stats_.write(stats);
+            break;
+        }
+
+        // overran : resynchronise instead of bursting to catch up
+        next += period_ns;
+        const uint64_t done = SystemClock::monotonic();
+        if(done >= next)
+        {
+            stats.overruns++;
+            next = done + period_ns;
+        }
+
+        if(++stats.cycles >= window)
+        {
+            stats.total_overruns = (total_overruns_ += stats.overruns);
+            stats.stale_commands = stale_commands_;
+            stale_commands_ = 0;
+            stats.dropped_samples = dropped_samples_;
+            loop_stats_.write(stats);
+            stats = LoopStats();
+        }
+    }
+}
+
+/**
+ * @brief Waiting for the exchange thread to end, when the robot is lost or ROS
+ * shuts down
+ *
+ */
+void TrakrROS2Node::waitExchange()
+{
+    if(exchange_thread_.joinable())
+    {
+        exchange_thread_.join();
+    }
+}
+
+/**
+ * @brief CPU pinning, SCHED_FIFO and locked memory, as configured
+ *
+ */
+void TrakrROS2Node::configureExchangeThread_()
+{
+    int cpu = this->get_parameter("exchange_cpu").as_int();
+    if(cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        {
+            RCLCPP_WARN(this->get_logger(), "Unable to pin the exchange thread to cpu %d", cpu);
+        }
+    }
+
+    int priority = this->get_parameter("exchange_priority").as_int();
+    if(priority > 0)
+    {
+        if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        {
+            RCLCPP_WARN(this->get_logger(), "Unable to lock memory (%s)", strerror(errno));
+        }
+
+        struct sched_param param;
+        param.sched_priority = priority;
+        if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+        {
+            RCLCPP_WARN(this->get_logger(), "Unable to set SCHED_FIFO priority %d (needs CAP_SYS_NICE or rtprio limit)", priority);
+        }
+    }
+}
+
+/**
+ * @brief Publishing the loop jitter of the last window on /diagnostics
+ *
+ */
+void TrakrROS2Node::sendDiagnostics_()
+{
+    loop_stats_.update();
+    const LoopStats &stats = loop_stats_.front();
+    if((stats.cycles == 0) && is_connected_)
+    {
+        return;
+    }
+
+    const double cycles = std::max<uint64_t>(stats.cycles, 1);
+    const double mean = stats.latency_sum / cycles;
+    const double stddev = std::sqrt(std::max(0.0, stats.latency_sq_sum / cycles - mean * mean));
+    const double warn = this->get_parameter("jitter_warn_us").as_double();
+
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.name = "trakr_ros2: robot exchange loop";
+    status.hardware_id = this->get_parameter("robot_ip").as_string();
+    if(!is_connected_)
+    {
+        status.level = diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+        status.message = "robot disconnected; exchange stopped";
+    }
+    else if((stats.jitter_max > warn) || (stats.overruns > 0))
+    {
+        status.level = diagnostic_msgs::msg::DiagnosticStatus::WARN;
+        status.message = "loop jitter above jitter_warn_us";
+    }
+    else
+    {
+        status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+        status.message = "ok";
+    }
+
+    auto value = [&status](const std::string &key, double number)
+    {
+        diagnostic_msgs::msg::KeyValue pair;
+        pair.key = key;
+        pair.value = std::to_string(number);
+        status.values.push_back(pair);
     };
+    value("cycles", stats.cycles);
+    value("wakeup_latency_mean_us", mean);
+    value("wakeup_latency_stddev_us", stddev);
+    value("wakeup_latency_max_us", stats.latency_max);
+    value("period_jitter_max_us", stats.jitter_max);
+    value("overruns", stats.overruns);
+    value("overruns_total", stats.total_overruns);
+    if(low_level_)
+    {
+        value("stale_joint_commands", stats.stale_commands);
+    }
+    if(torso_samples_)
+    {
+        value("dropped_batch_samples_total", stats.dropped_samples);
+    }
 
-    joint.header.stamp.sec = static_cast<int32_t>(state_.joint.timestamp / (unsigned long long)(1e9));
-    joint.header.stamp.nanosec = static_cast<int32_t>(state_.joint.timestamp % (unsigned long long)(1e9));
-    joint.position = std::vector<double>(state_.joint.pos.data(), state_.joint.pos.data() + state_.joint.pos.size());
-    joint.velocity = std::vector<double>(state_.joint.vel.data(), state_.joint.vel.data() + state_.joint.vel.size());
-    joint.effort = std::vector<double>(state_.joint.tor.data(), state_.joint.tor.data() + state_.joint.tor.size());
+    diagnostic_msgs::msg::DiagnosticArray array;
+    array.header.stamp = this->now();
+    array.status.push_back(status);
+    diagnostics_->publish(array);
+}
 
-    joint_->publish(joint);
+/**
+ * @brief Latest state published by the exchange loop
+ *
+ */
+const AlliedDataTypes::State& TrakrROS2Node::latestState_()
+{
+    // single reader : every publisher runs in the same mutually exclusive group
+    snapshot_.update();
+    return snapshot_.front();
+}
 
-    // Creating Imu message
-    imu.header.stamp.sec = static_cast<int32_t>(state_.imu.timestamp / (unsigned long long)(1e9));
-    imu.header.stamp.nanosec = static_cast<int32_t>(state_.imu.timestamp % (unsigned long long)(1e9));
+/**
+ * @brief Publishing the joint states of robot
+ *
+ */
+void TrakrROS2Node::sendJointState_()
+{
+    TRAKR_TRACE_SCOPE("TrakrROS2Node::sendJointState");
+
+    const AlliedDataTypes::State &state = latestState_();
+
+    // messages are preallocated in createDataStreams_(); only values are written here,
+    // then copied into a loaned message where the middleware lends them
+    sensor_msgs::msg::JointState &joint = joint_msg_;
+
+    joint.header.stamp.sec = static_cast<int32_t>(state.joint.timestamp / (unsigned long long)(1e9));
+    joint.header.stamp.nanosec = static_cast<int32_t>(state.joint.timestamp % (unsigned long long)(1e9));
+    std::copy(state.joint.pos.data(), state.joint.pos.data() + NDOF, joint.position.begin());
+    std::copy(state.joint.vel.data(), state.joint.vel.data() + NDOF, joint.velocity.begin());
+    std::copy(state.joint.tor.data(), state.joint.tor.data() + NDOF, joint.effort.begin());
+
+    publish_(*joint_, joint);
+}
+
+/**
+ * @brief Publishing the imu data of robot
+ *
+ */
+void TrakrROS2Node::sendImu_()
+{
+    TRAKR_TRACE_SCOPE("TrakrROS2Node::sendImu");
+
+    const AlliedDataTypes::State &state = latestState_();
+    sensor_msgs::msg::Imu &imu = imu_msg_;
+
+    imu.header.stamp.sec = static_cast<int32_t>(state.imu.timestamp / (unsigned long long)(1e9));
+    imu.header.stamp.nanosec = static_cast<int32_t>(state.imu.timestamp % (unsigned long long)(1e9));
     Eigen::Quaternionf q;
-    q = Eigen::AngleAxisf(state_.imu.euler[2], Eigen::Vector3f::UnitZ())
-        * Eigen::AngleAxisf(state_.imu.euler[1], Eigen::Vector3f::UnitY())
-        * Eigen::AngleAxisf(state_.imu.euler[0], Eigen::Vector3f::UnitX());
+    q = Eigen::AngleAxisf(state.imu.euler[2], Eigen::Vector3f::UnitZ())
+        * Eigen::AngleAxisf(state.imu.euler[1], Eigen::Vector3f::UnitY())
+        * Eigen::AngleAxisf(state.imu.euler[0], Eigen::Vector3f::UnitX());
     imu.orientation.w = q.w();
     imu.orientation.x = q.x();
     imu.orientation.y = q.y();
     imu.orientation.z = q.z();
 
-    imu.angular_velocity.x = state_.imu.gyro[0];
-    imu.angular_velocity.y = state_.imu.gyro[1];
-    imu.angular_velocity.z = state_.imu.gyro[2];
+    imu.angular_velocity.x = state.imu.gyro[0];
+    imu.angular_velocity.y = state.imu.gyro[1];
+    imu.angular_velocity.z = state.imu.gyro[2];
+
+    imu.linear_acceleration.x = state.imu.acc[0];
+    imu.linear_acceleration.y = state.imu.acc[1];
+    imu.linear_acceleration.z = state.imu.acc[2];
+
+    publish_(*imu_, imu);
+}
 
-    imu.linear_acceleration.x = state_.imu.acc[0];
-    imu.linear_acceleration.y = state_.imu.acc[1];
-    imu.linear_acceleration.z = state_.imu.acc[2];
+/**
+ * @brief Publishing the body twist of robot
+ *
+ */
+void TrakrROS2Node::sendBodyTwist_()
+{
+    TRAKR_TRACE_SCOPE("TrakrROS2Node::sendBodyTwist");
 
-    imu_->publish(imu);
+    const AlliedDataTypes::State &state = latestState_();
+    geometry_msgs::msg::Twist &body_twist = body_twist_msg_;
 
-    // Creating Twist message
-    body_twist.angular.x = state_.torso.vel[0];
-    body_twist.angular.y = state_.torso.vel[1];
-    body_twist.angular.z = state_.torso.vel[2];
-    body_twist.linear.x = state_.torso.vel[3];
-    body_twist.linear.y = state_.torso.vel[4];
-    body_twist.linear.z = state_.torso.vel[5];
+    body_twist.angular.x = state.torso.vel[0];
+    body_twist.angular.y = state.torso.vel[1];
+    body_twist.angular.z = state.torso.vel[2];
+    body_twist.linear.x = state.torso.vel[3];
+    body_twist.linear.y = state.torso.vel[4];
+    body_twist.linear.z = state.torso.vel[5];
 
-    body_twist_->publish(body_twist);
+    publish_(*body_twist_, body_twist);
 }
 
 /**
- * @brief Getting user plan through subscription callback
+ * @brief Torso position and orientation from the EKF pose (roll, pitch, yaw, x, y, z)
  *
  */
-void TrakrROS2Node::planCallback_(const geometry_msgs::msg::Twist::SharedPtr msg)
+void TrakrROS2Node::torsoPose_(const double pos[6], Eigen::Vector3d &position, Eigen::Quaterniond &orientation)
 {
-    mut_plan_.lock();
-    plan_.torso.vel(2) = msg->angular.z;
-    plan_.torso.vel(3) = msg->linear.x;
-    plan_.torso.vel(4) = msg->linear.y;
-    mut_plan_.unlock();
+    position = Eigen::Vector3d(pos[3], pos[4], pos[5]);
+    orientation = Eigen::AngleAxisd(pos[2], Eigen::Vector3d::UnitZ())
+                  * Eigen::AngleAxisd(pos[1], Eigen::Vector3d::UnitY())
+                  * Eigen::AngleAxisd(pos[0], Eigen::Vector3d::UnitX());
 }
 
 /**
- * @brief Wait for the robot to acknowledge the configuration
- * TODO: timeout waiting for acknowledgement for too long
+ * @brief Torso twist in the base frame, from the EKF velocities given in the
+ * robot-aligned world frame (world frame turned by the yaw)
  *
  */
-void TrakrROS2Node::waitForResponse_(std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::torsoTwist_(const double pos[6], const double vel[6], Eigen::Vector3d &linear, Eigen::Vector3d &angular)
 {
-    while(!(config_status_ > 1) && rclcpp::ok())
-    {
-        rclcpp::sleep_for(std::chrono::microseconds(1000));
-    }
+    // yaw-aligned frame to base frame : undoing pitch, then roll
+    const Eigen::Matrix3d to_base = (Eigen::AngleAxisd(pos[1], Eigen::Vector3d::UnitY())
+                                     * Eigen::AngleAxisd(pos[0], Eigen::Vector3d::UnitX())).toRotationMatrix().transpose();
+    angular = to_base * Eigen::Vector3d(vel[0], vel[1], vel[2]);
+    linear = to_base * Eigen::Vector3d(vel[3], vel[4], vel[5]);
+}
 
-    if(config_status_ == 2)
-    {
-        response->success = true;
-        rclcpp::sleep_for(std::chrono::milliseconds(1250));
-    }
-    else if(config_status_ == 3)
+/**
+ * @brief Publishing the odometry, and its transform, from the EKF torso estimate
+ *
+ */
+void TrakrROS2Node::sendOdometry_()
+{
+    TRAKR_TRACE_SCOPE("TrakrROS2Node::sendOdometry");
+
+    const AlliedDataTypes::State &state = latestState_();
+    nav_msgs::msg::Odometry &odom = odom_msg_;
+
+    odom.header.stamp.sec = static_cast<int32_t>(state.torso.timestamp / (unsigned long long)(1e9));
+    odom.header.stamp.nanosec = static_cast<int32_t>(state.torso.timestamp % (unsigned long long)(1e9));
+
+    Eigen::Vector3d position, linear, angular;
+    Eigen::Quaterniond orientation;
+    torsoPose_(state.torso.pos.data(), position, orientation);
+    torsoTwist_(state.torso.pos.data(), state.torso.vel.data(), linear, angular);
+
+    odom.pose.pose.position.x = position.x();
+    odom.pose.pose.position.y = position.y();
+    odom.pose.pose.position.z = position.z();
+    odom.pose.pose.orientation.w = orientation.w();
+    odom.pose.pose.orientation.x = orientation.x();
+    odom.pose.pose.orientation.y = orientation.y();
+    odom.pose.pose.orientation.z = orientation.z();
+
+    odom.twist.twist.linear.x = linear.x();
+    odom.twist.twist.linear.y = linear.y();
+    odom.twist.twist.linear.z = linear.z();
+    odom.twist.twist.angular.x = angular.x();
+    odom.twist.twist.angular.y = angular.y();
+    odom.twist.twist.angular.z = angular.z();
+
+    publish_(*odom_, odom);
+
+    if(tf_broadcaster_)
     {
-        response->success = false;
+        tf_msg_.header.stamp = odom.header.stamp;
+        tf_msg_.transform.translation.x = position.x();
+        tf_msg_.transform.translation.y = position.y();
+        tf_msg_.transform.translation.z = position.z();
+        tf_msg_.transform.rotation = odom.pose.pose.orientation;
+        tf_broadcaster_->sendTransform(tf_msg_);
     }
 }
 
 /**
- * @brief Setting configuration corresponding to AIModeWalk
+ * @brief Publishing the torso states queued by the exchange loop, odom_batch_size_ per message
  *
  */
-void TrakrROS2Node::setAIMode1_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::sendOdometryBatch_()
 {
-    (void)request;
+    TRAKR_TRACE_SCOPE("TrakrROS2Node::sendOdometryBatch");
+
+    trakr_ros2::msg::TorsoBatch &batch = batch_msg_;
+    Eigen::Vector3d position, linear, angular;
+    Eigen::Quaterniond orientation;
+
+    while(const TorsoSample* sample = torso_samples_->front())
+    {
+        torsoPose_(sample->pos, position, orientation);
+        torsoTwist_(sample->pos, sample->vel, linear, angular);
+
+        batch.stamp.push_back(sample->stamp);
+        batch.pose.insert(batch.pose.end(), {position.x(), position.y(), position.z(),
+                                             orientation.x(), orientation.y(), orientation.z(), orientation.w()});
+        batch.twist.insert(batch.twist.end(), {linear.x(), linear.y(), linear.z(),
+                                               angular.x(), angular.y(), angular.z()});
+        torso_samples_->pop();
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eMotion;
-    config_.motion.strategy.type = MotionModes::eAIMode;
-    config_.motion.strategy.seq = MotionGaits::eWalk;
-    set_config_ = true;
-    mut_config_.unlock();
+        if(batch.stamp.size() == odom_batch_size_)
+        {
+            batch.header.stamp.sec = static_cast<int32_t>(batch.stamp.back() / (unsigned long long)(1e9));
+            batch.header.stamp.nanosec = static_cast<int32_t>(batch.stamp.back() % (unsigned long long)(1e9));
+            publish_(*odom_batch_, batch);
 
-    waitForResponse_(response);
+            batch.stamp.clear();
+            batch.pose.clear();
+            batch.twist.clear();
+        }
+    }
 }
 
 /**
- * @brief Setting configuration corresponding to AIModeClimb
+ * @brief Getting user plan through subscription callback
  *
  */
-void TrakrROS2Node::setAIMode2_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::planCallback_(const geometry_msgs::msg::Twist::SharedPtr msg)
 {
-    (void)request;
+    // single writer : the subscription runs in the node's default (mutually exclusive) group
+    cmd_vel_.write(*msg);
+}
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eMotion;
-    config_.motion.strategy.type = MotionModes::eAIMode;
-    config_.motion.strategy.seq = MotionGaits::eClimb;
-    set_config_ = true;
-    mut_config_.unlock();
+/**
+ * @brief Callback to joint commands : pos, vel, tor, kp and kd of every joint, in this order
+ *
+ */
+void TrakrROS2Node::jointCommandCallback_(const std_msgs::msg::Float64MultiArray::SharedPtr msg)
+{
+    if(msg->data.size() != 5 * NDOF)
+    {
+        RCLCPP_WARN_THROTTLE(this->get_logger(), *this->get_clock(), 1000,
+                             "Ignoring joint command of %zu values (expected %d)", msg->data.size(), 5 * NDOF);
+        return;
+    }
 
-    waitForResponse_(response);
+    // single writer : the subscription runs in the node's default (mutually exclusive) group
+    JointCommand &cmd = joint_cmd_.back();
+    cmd.pos = Eigen::Map<const JointVector>(msg->data.data());
+    cmd.vel = Eigen::Map<const JointVector>(msg->data.data() + NDOF);
+    cmd.tor = Eigen::Map<const JointVector>(msg->data.data() + 2 * NDOF);
+    cmd.kp = Eigen::Map<const JointVector>(msg->data.data() + 3 * NDOF);
+    cmd.kd = Eigen::Map<const JointVector>(msg->data.data() + 4 * NDOF);
+    cmd.stamp = SystemClock::monotonic();
+    joint_cmd_.publish();
 }
 
 /**
- * @brief Setting configuration corresponding to ClassicalModeTrot
+ * @brief Writing the recorded trace to the "trace_file" parameter
  *
  */
-void TrakrROS2Node::setClassicalMode_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::saveTrace_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
+                               std::shared_ptr<std_srvs::srv::Trigger::Response> response)
 {
     (void)request;
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eMotion;
-    config_.motion.strategy.type = MotionModes::eClassicalMode;
-    config_.motion.strategy.seq = MotionGaits::eTrot;
-    set_config_ = true;
-    mut_config_.unlock();
+    if(trace_file_.empty())
+    {
+        response->success = false;
+        response->message = "tracing disabled; set the trace_file parameter";
+        return;
+    }
 
-    waitForResponse_(response);
+    response->success = Trace::writeChrome(trace_file_);
+    response->message = trace_file_;
 }
 
 /**
- * @brief Setting configuration corresponding to GestureMode-Reorientation
+ * @brief Accepting a goal if it names a valid configuration and no other change is pending
  *
  */
-void TrakrROS2Node::setGestureMode_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+rclcpp_action::GoalResponse TrakrROS2Node::handleModeGoal_(const rclcpp_action::GoalUUID &uuid,
+                                                           std::shared_ptr<const SetMode::Goal> goal)
 {
-    (void)request;
+    (void)uuid;
+
+    if(mode_change_.has_value())
+    {
+        RCLCPP_WARN(this->get_logger(), "Rejecting mode change : another one is in progress");
+        return rclcpp_action::GoalResponse::REJECT;
+    }
+
+    if(!is_connected_)
+    {
+        RCLCPP_WARN(this->get_logger(), "Rejecting mode change : robot disconnected");
+        return rclcpp_action::GoalResponse::REJECT;
+    }
+
+    bool valid = false;
+    if(goal->planner == SetMode::Goal::PLANNER_MOTION)
+    {
+        valid = (goal->strategy_type >= SetMode::Goal::STRATEGY_CLASSICAL)
+                && (goal->strategy_type <= SetMode::Goal::STRATEGY_DEVELOPER)
+                && (goal->strategy_seq <= SetMode::Goal::GAIT_CLIMB);
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eGesture;
-    config_.motion.sequence.type = GestureTypes::eOrientation;
-    config_.motion.sequence.seq = 0;
-    set_config_ = true;
-    mut_config_.unlock();
+        // developer mode follows plan_.joint, which only the low level node fills
+        if((goal->strategy_type == SetMode::Goal::STRATEGY_DEVELOPER) && !low_level_)
+        {
+            RCLCPP_WARN(this->get_logger(), "Rejecting mode change : developer mode needs the node in low level");
+            return rclcpp_action::GoalResponse::REJECT;
+        }
+    }
+    else if(goal->planner == SetMode::Goal::PLANNER_GESTURE)
+    {
+        valid = (goal->gesture_type >= SetMode::Goal::GESTURE_STAND_UP)
+                && (goal->gesture_type <= SetMode::Goal::GESTURE_RIGHT_HANDSHAKE);
+    }
 
-    waitForResponse_(response);
+    if(!valid)
+    {
+        RCLCPP_WARN(this->get_logger(), "Rejecting mode change : invalid planner %d, strategy %d/%d, gesture %d",
+                    goal->planner, goal->strategy_type, goal->strategy_seq, goal->gesture_type);
+        return rclcpp_action::GoalResponse::REJECT;
+    }
+    return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
 }
 
 /**
- * @brief Setting configuration corresponding to GestureMode-StandUp
+ * @brief Cancelling stops the wait; a configuration already sent is not undone
  *
  */
-void TrakrROS2Node::setGestureStandUp_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+rclcpp_action::CancelResponse TrakrROS2Node::handleModeCancel_(const std::shared_ptr<GoalHandleSetMode> goal_handle)
 {
-    (void)request;
-
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eGesture;
-    config_.motion.sequence.type = GestureTypes::eStandUp;
-    config_.motion.sequence.seq = 0;
-    set_config_ = true;
-    mut_config_.unlock();
+    (void)goal_handle;
+    return rclcpp_action::CancelResponse::ACCEPT;
+}
 
-    waitForResponse_(response);
+/**
+ * @brief Sending an accepted goal to the robot
+ *
+ */
+void TrakrROS2Node::handleModeAccepted_(const std::shared_ptr<GoalHandleSetMode> goal_handle)
+{
+    ModeChange change;
+    change.goal = goal_handle;
+    startModeChange_(*goal_handle->get_goal(), change);
 }
 
 /**
- * @brief Setting configuration corresponding to GestureMode-SitDown
+ * @brief Handing the configuration to the exchange loop, then following the
+ * robot's answer from the mode timer
  *
  */
-void TrakrROS2Node::setGestureSitDown_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::startModeChange_(const SetMode::Goal &goal, ModeChange &change)
 {
-    (void)request;
+    QuadDataTypes::CONFIG_SET &config = beginConfig_();
+    if(goal.planner == SetMode::Goal::PLANNER_MOTION)
+    {
+        config.motion.planner = MotionDataTypes::TaskTypes::eMotion;
+        config.motion.strategy.type = static_cast<MotionModes>(goal.strategy_type);
+        config.motion.strategy.seq = static_cast<MotionGaits>(goal.strategy_seq);
+    }
+    else
+    {
+        config.motion.planner = MotionDataTypes::TaskTypes::eGesture;
+        config.motion.sequence.type = static_cast<GestureTypes>(goal.gesture_type);
+        config.motion.sequence.seq = 0;
+    }
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eGesture;
-    config_.motion.sequence.type = GestureTypes::eSitDown;
-    config_.motion.sequence.seq = 0;
-    set_config_ = true;
-    mut_config_.unlock();
+    const double timeout = (goal.timeout > 0.0) ? goal.timeout : this->get_parameter("mode_change_timeout").as_double();
+    change.ticket = commitConfig_();
+    change.start = SystemClock::monotonic();
+    change.deadline = change.start + static_cast<uint64_t>(timeout * 1e9);
 
-    waitForResponse_(response);
+    mode_change_ = change;
+    mode_timer_->reset();
 }
 
 /**
- * @brief Setting configuration corresponding to GestureMode-LeftHandShake
+ * @brief Following the pending mode change until the robot answers, it times
+ * out or the goal is cancelled
  *
  */
-void TrakrROS2Node::setGestureLeftHandShake_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::pollModeChange_()
 {
-    (void)request;
+    if(!mode_change_.has_value())
+    {
+        mode_timer_->cancel();
+        return;
+    }
+
+    ModeChange &change = *mode_change_;
+    const uint64_t now = SystemClock::monotonic();
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eGesture;
-    config_.motion.sequence.type = GestureTypes::eLeftShakeHand;
-    config_.motion.sequence.seq = 0;
-    set_config_ = true;
-    mut_config_.unlock();
+    // statuses count only once the exchange loop has sent this very request
+    const int status = (config_ticket_.load() == change.ticket) ? config_status_.load() : 0;
 
-    waitForResponse_(response);
+    if(status == 2)
+    {
+        finishModeChange_(true, "configuration applied by the robot");
+    }
+    else if(status == 3)
+    {
+        finishModeChange_(false, "configuration rejected by the robot");
+    }
+    else if(!is_connected_)
+    {
+        finishModeChange_(false, "robot disconnected");
+    }
+    else if(now >= change.deadline)
+    {
+        finishModeChange_(false, "no answer from the robot before the timeout");
+    }
+    else if(change.goal && change.goal->is_canceling())
+    {
+        auto result = std::make_shared<SetMode::Result>();
+        result->success = false;
+        result->message = "cancelled; the configuration may still be applied by the robot";
+        change.goal->canceled(result);
+        mode_change_.reset();
+        mode_timer_->cancel();
+    }
+    else if(change.goal && ((status != change.status) || (now >= change.next_feedback)))
+    {
+        auto feedback = std::make_shared<SetMode::Feedback>();
+        feedback->elapsed = (now - change.start) * 1e-9;
+        feedback->status = status;
+        change.goal->publish_feedback(feedback);
+        change.status = status;
+        change.next_feedback = now + 100000000ull;
+    }
 }
 
 /**
- * @brief Setting configuration corresponding to GestureMode-RightHandShake
+ * @brief Answering the action goal or the service call of the pending change
  *
  */
-void TrakrROS2Node::setGestureRightHandShake_(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
-                                std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+void TrakrROS2Node::finishModeChange_(bool success, const std::string &message)
 {
-    (void)request;
+    ModeChange &change = *mode_change_;
 
-    mut_config_.lock();
-    config_.motion.planner = MotionDataTypes::TaskTypes::eGesture;
-    config_.motion.sequence.type = GestureTypes::eRightShakeHand;
-    config_.motion.sequence.seq = 0;
-    set_config_ = true;
-    mut_config_.unlock();
+    if(change.goal)
+    {
+        auto result = std::make_shared<SetMode::Result>();
+        result->success = success;
+        result->message = message;
+        if(success)
+        {
+            change.goal->succeed(result);
+        }
+        else
+        {
+            change.goal->abort(result);
+        }
+    }
+    else
+    {
+        std_srvs::srv::Trigger::Response response;
+        response.success = success;
+        response.message = message;
+        change.service->send_response(*change.request_id, response);
+    }
 
-    waitForResponse_(response);
+    if(!success)
+    {
+        RCLCPP_WARN(this->get_logger(), "Mode change failed : %s", message.c_str());
+    }
+
+    mode_change_.reset();
+    mode_timer_->cancel();
 }
 
 /**
- * @brief main code
+ * @brief Configuration to be edited, starting from the robot's latest
  *
  */
-int main(int argc, char ** argv)
+QuadDataTypes::CONFIG_SET& TrakrROS2Node::beginConfig_()
 {
-    rclcpp::init(argc, argv);
+    // single reader and writer : every mode change runs in the same mutually exclusive group
+    robot_config_.update();
+    config_request_.back().config = robot_config_.front();
+    return config_request_.back().config;
+}
 
-    rclcpp::executors::MultiThreadedExecutor executor;
+/**
+ * @brief Handing the edited configuration to the exchange loop
+ *
+ */
+uint32_t TrakrROS2Node::commitConfig_()
+{
+    config_request_.back().ticket = ++config_tickets_;
+    config_request_.publish();
+    return config_tickets_;
+}
 
-    std::shared_ptr<TrakrROS2Node> node_ = std::make_shared<TrakrROS2Node>();
-    executor.add_node(node_);
-    executor.spin();
-    
-    rclcpp::shutdown();
+#include "rclcpp_components/register_node_macro.hpp"
 
-    return 0;
-}
\ No newline at end of file
+RCLCPP_COMPONENTS_REGISTER_NODE(TrakrROS2Node)